@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "adaptive_samples.h"
+#include "container.h"
 #include "misc/utils.h"
 
 
@@ -24,7 +25,7 @@ AdaptiveSamples::AdaptiveSamples(const RLCSA& rlcsa, const std::string& base_nam
   ok(false)
 {
   Parameters parameters;
-  parameters.read(base_name + PARAMETERS_EXTENSION);
+  readIndexParameters(base_name, parameters);
   this->use_candidates = parameters.get(CANDIDATE_SAMPLES);
   this->half_greedy = parameters.get(HALF_GREEDY_SAMPLES);
   this->window_size = parameters.get(SAMPLE_WINDOW_SIZE);
@@ -34,9 +35,8 @@ AdaptiveSamples::AdaptiveSamples(const RLCSA& rlcsa, const std::string& base_nam
     this->promote_probability = 1.0 / parameters.get(SAMPLE_PROMOTE_RATE);
   }
 
-  std::string file_name = base_name + SA_SAMPLES_EXTENSION;
-  std::ifstream sample_file(file_name.c_str(), std::ios_base::binary);
-  if(!sample_file)
+  std::ifstream sample_file;
+  if(!openIndexFile(base_name, SA_SAMPLES_EXTENSION, sample_file))
   {
     std::cerr << "AdaptiveSamples: Cannot open sample file!" << std::endl;
     return;
@@ -66,6 +66,11 @@ Alphabet::initialize(const usint* counts)
     }
   }
 
+  for(usint c = 0; c < SMALL_ALPHABET; c++)
+  {
+    this->char_ends[c] = (c + 1 < this->chars ? this->index_ranges[this->text_chars[c]].second + 1 : WORD_MAX);
+  }
+
   this->ok = true;
 }
 
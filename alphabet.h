@@ -14,6 +14,9 @@ namespace CSA
 class Alphabet
 {
   public:
+    // Alphabets up to this size use a branchless charAt().
+    const static usint SMALL_ALPHABET = 16;
+
     explicit Alphabet(const usint* counts);
     explicit Alphabet(std::ifstream& file);
     explicit Alphabet(FILE* file);
@@ -38,6 +41,14 @@ class Alphabet
 
     inline usint charAt(usint i) const
     {
+      if(this->chars <= SMALL_ALPHABET)
+      {
+        // The number of ranges ending before i is the rank of the character.
+        usint rank = 0;
+        for(usint j = 0; j < SMALL_ALPHABET; j++) { rank += (this->char_ends[j] <= i); }
+        return this->text_chars[rank];
+      }
+
       const usint* curr = &(this->text_chars[this->index_pointers[i / this->index_rate]]);
       while(i > this->index_ranges[*curr].second) { curr++; }
       return *curr;
@@ -54,6 +65,9 @@ class Alphabet
     usint index_pointers[CHARS]; // which of the above is at i * index_rate
     usint index_rate;
 
+    // char_ends[j] is one past the range of text_chars[j], or WORD_MAX for the last one.
+    usint char_ends[SMALL_ALPHABET];
+
     bool ok;
 
     void initialize(const usint* counts);
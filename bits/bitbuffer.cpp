@@ -1,7 +1,12 @@
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "bitbuffer.h"
+#include "../misc/utils.h"
 
 
 namespace CSA
@@ -9,6 +14,89 @@ namespace CSA
 
 //--------------------------------------------------------------------------
 
+FileMap::FileMap(const std::string& file_name) :
+  data(0), size(0), pos(0), mapping(0), mapped_bytes(0), ok(false)
+{
+  this->map(file_name, 0, 0, true);
+}
+
+FileMap::FileMap(const std::string& file_name, usint offset, usint bytes) :
+  data(0), size(0), pos(0), mapping(0), mapped_bytes(0), ok(false)
+{
+  this->map(file_name, offset, bytes, false);
+}
+
+FileMap::~FileMap()
+{
+  if(this->mapping != 0) { munmap(this->mapping, this->mapped_bytes); }
+}
+
+void
+FileMap::map(const std::string& file_name, usint offset, usint bytes, bool whole_file)
+{
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if(fd < 0)
+  {
+    std::cerr << "FileMap: Cannot open file " << file_name << "!" << std::endl;
+    return;
+  }
+  struct stat info;
+  if(fstat(fd, &info) != 0 || info.st_size <= 0)
+  {
+    std::cerr << "FileMap: Cannot map empty file " << file_name << "!" << std::endl;
+    close(fd);
+    return;
+  }
+  if(whole_file) { bytes = info.st_size; }
+  if(bytes == 0 || offset + bytes > (usint)(info.st_size))
+  {
+    std::cerr << "FileMap: Invalid range in file " << file_name << "!" << std::endl;
+    close(fd);
+    return;
+  }
+
+  // The mapping must start at a page boundary.
+  usint page_size = sysconf(_SC_PAGESIZE);
+  usint start = offset - offset % page_size;
+  this->mapped_bytes = bytes + (offset - start);
+  void* result = mmap(0, this->mapped_bytes, PROT_READ, MAP_SHARED, fd, start);
+  close(fd);
+  if(result == MAP_FAILED)
+  {
+    std::cerr << "FileMap: Cannot map file " << file_name << "!" << std::endl;
+    this->mapped_bytes = 0;
+    return;
+  }
+
+  this->mapping = result;
+  this->data = (const usint*)((char*)result + (offset - start));
+  this->size = bytes / sizeof(usint);
+  this->ok = true;
+}
+
+void
+FileMap::prefetch() const
+{
+  if(this->mapping != 0) { madvise(this->mapping, this->mapped_bytes, MADV_WILLNEED); }
+}
+
+const usint*
+FileMap::readWords(usint words)
+{
+  if(this->ok && words <= this->size - this->pos)
+  {
+    const usint* result = this->data + this->pos;
+    this->pos += words;
+    return result;
+  }
+
+  if(this->ok) { std::cerr << "FileMap: Unexpected end of file!" << std::endl; }
+  this->ok = false;
+  return 0;
+}
+
+//--------------------------------------------------------------------------
+
 ReadBuffer::ReadBuffer(std::ifstream& file, usint words) :
   size(words),
   item_bits(1),
@@ -67,6 +155,26 @@ ReadBuffer::ReadBuffer(FILE* file, usint _items, usint item_size) :
   this->reset();
 }
 
+ReadBuffer::ReadBuffer(FileMap& file, usint words) :
+  size(words),
+  item_bits(1),
+  items(0),
+  free_buffer(false)
+{
+  this->data = file.readWords(this->size);
+  this->reset();
+}
+
+ReadBuffer::ReadBuffer(FileMap& file, usint _items, usint item_size) :
+  item_bits(item_size),
+  items(_items),
+  free_buffer(false)
+{
+  this->size = bitsToWords(this->items * this->item_bits);
+  this->data = file.readWords(this->size);
+  this->reset();
+}
+
 ReadBuffer::ReadBuffer(const usint* buffer, usint words) :
   size(words),
   item_bits(1),
@@ -126,6 +234,12 @@ ReadBuffer::writeTo(FILE* file) const
   std::fwrite(this->data, this->size * sizeof(usint), 1, file);
 }
 
+usint
+ReadBuffer::checksum(usint hash) const
+{
+  return hashWords(this->data, this->size, hash);
+}
+
 void
 ReadBuffer::moveBuffer(const usint* buffer)
 {
@@ -5,6 +5,7 @@
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <string>
 
 #include "../misc/definitions.h"
 
@@ -13,6 +14,59 @@ namespace CSA
 {
 
 
+/*
+  A read-only memory mapping of a file, read sequentially one word at a time.
+  Structures loaded from the mapping point directly into it, so the mapping must
+  outlive them. If the file ends too early, isOk() becomes false and readWords()
+  returns 0. The structures check isOk() before using the data.
+*/
+
+class FileMap
+{
+  public:
+    explicit FileMap(const std::string& file_name);
+
+    // Maps the given range of the file. The offset and the size are in bytes.
+    FileMap(const std::string& file_name, usint offset, usint bytes);
+
+    ~FileMap();
+
+    inline bool isOk() const { return this->ok; }
+
+    // Returns the next words and advances past them.
+    const usint* readWords(usint words);
+    inline usint readWord()
+    {
+      const usint* word = this->readWords(1);
+      return (word != 0 ? *word : 0);
+    }
+
+    inline usint getSize() const { return this->size; }      // In words.
+    inline usint getPosition() const { return this->pos; }   // In words.
+    inline void seek(usint position) { this->pos = std::min(position, this->size); }
+
+    // Asks the kernel to read the mapped data in the background.
+    void prefetch() const;
+
+  private:
+    const usint* data;
+    usint size, pos;
+    void* mapping;
+    usint mapped_bytes;
+    bool  ok;
+
+    void map(const std::string& file_name, usint offset, usint bytes, bool whole_file);
+
+    // These are not allowed.
+    FileMap();
+    FileMap(const FileMap&);
+    FileMap& operator = (const FileMap&);
+};
+
+
+//--------------------------------------------------------------------------
+
+
 class ReadBuffer
 {
   public:
@@ -21,6 +75,10 @@ class ReadBuffer
     ReadBuffer(std::ifstream& file, usint _items, usint item_size);
     ReadBuffer(FILE* file, usint _items, usint item_size);
 
+    // These versions point to the mapped file and do not delete the data.
+    ReadBuffer(FileMap& file, usint words);
+    ReadBuffer(FileMap& file, usint _items, usint item_size);
+
     // These versions do not delete the data when deleted.
     ReadBuffer(const usint* buffer, usint words);
     ReadBuffer(const usint* buffer, usint _items, usint item_size);
@@ -37,6 +95,9 @@ class ReadBuffer
     void writeTo(FILE* file) const;
     inline void writeBuffer(FILE* file) const { this->writeTo(file); }
 
+    // Hash of the stored words, continuing from the given value.
+    usint checksum(usint hash) const;
+
     // The buffer will no longer own the data.
     void moveBuffer(const usint* buffer);
 
@@ -2,14 +2,15 @@
 #include <cstdlib>
 
 #include "bitvector.h"
+#include "../misc/utils.h"
 
 
 namespace CSA
 {
 
 
-BitVector::BitVector(std::ifstream& file) :
-  rank_index(0), select_index(0)
+BitVector::BitVector(std::ifstream& file, bool stored_indexes) :
+  delete_array(true), rank_index(0), select_index(0)
 {
   this->readHeader(file);
   this->readArray(file);
@@ -17,12 +18,26 @@ BitVector::BitVector(std::ifstream& file) :
   this->integer_bits = length(this->size);
   this->samples = new ReadBuffer(file, 2 * (this->number_of_blocks + 1), this->integer_bits);
 
+  if(stored_indexes) { this->readIndexes(file); return; }
   this->indexForRank();
   this->indexForSelect();
 }
 
 BitVector::BitVector(FILE* file) :
-  rank_index(0), select_index(0)
+  delete_array(true), rank_index(0), select_index(0)
+{
+  this->readHeader(file);
+  this->readArray(file);
+
+  this->integer_bits = length(this->size);
+  this->samples = new ReadBuffer(file, 2 * (this->number_of_blocks + 1), this->integer_bits);
+
+  this->indexForRank();
+  this->indexForSelect();
+}
+
+BitVector::BitVector(FileMap& file, bool stored_indexes) :
+  delete_array(false), samples(0), rank_index(0), select_index(0)
 {
   this->readHeader(file);
   this->readArray(file);
@@ -30,12 +45,15 @@ BitVector::BitVector(FILE* file) :
   this->integer_bits = length(this->size);
   this->samples = new ReadBuffer(file, 2 * (this->number_of_blocks + 1), this->integer_bits);
 
+  if(stored_indexes) { this->readIndexes(file); return; }
+  if(!(file.isOk())) { return; }
   this->indexForRank();
   this->indexForSelect();
 }
 
 BitVector::BitVector(VectorEncoder& encoder, usint universe_size) :
   size(universe_size), items(encoder.items),
+  delete_array(true),
   block_size(encoder.block_size),
   number_of_blocks(encoder.blocks),
   rank_index(0), select_index(0)
@@ -73,13 +91,13 @@ BitVector::BitVector(VectorEncoder& encoder, usint universe_size) :
 }
 
 BitVector::BitVector() :
-  array(0), samples(0), rank_index(0), select_index(0)
+  array(0), delete_array(true), samples(0), rank_index(0), select_index(0)
 {
 }
 
 BitVector::~BitVector()
 {
-  delete[] this->array;
+  if(this->delete_array) { delete[] this->array; }
   delete this->samples;
   delete this->rank_index;
   delete this->select_index;
@@ -103,6 +121,20 @@ BitVector::writeTo(FILE* file) const
   this->samples->writeBuffer(file);
 }
 
+void
+BitVector::writeIndexesTo(std::ofstream& file) const
+{
+  // Each index is stored as (rate, items, item size, data).
+  const ReadBuffer* indexes[2] = { this->rank_index, this->select_index };
+  const usint rates[2] = { this->rank_rate, this->select_rate };
+  for(usint i = 0; i < 2; i++)
+  {
+    usint header[3] = { rates[i], indexes[i]->getNumberOfItems(), indexes[i]->getItemSize() };
+    file.write((char*)header, sizeof(header));
+    indexes[i]->writeBuffer(file);
+  }
+}
+
 void
 BitVector::writeHeader(std::ofstream& file) const
 {
@@ -154,6 +186,15 @@ BitVector::readHeader(FILE* file)
   if(!std::fread(&(this->block_size), sizeof(this->block_size), 1, file)) { return; }
 }
 
+void
+BitVector::readHeader(FileMap& file)
+{
+  this->size = file.readWord();
+  this->items = file.readWord();
+  this->number_of_blocks = file.readWord();
+  this->block_size = file.readWord();
+}
+
 void
 BitVector::readArray(std::ifstream& file)
 {
@@ -171,6 +212,36 @@ BitVector::readArray(FILE* file)
   this->array = array_buffer;
 }
 
+void
+BitVector::readArray(FileMap& file)
+{
+  this->array = file.readWords(this->block_size * this->number_of_blocks);
+  this->delete_array = false;
+}
+
+void
+BitVector::readIndexes(std::ifstream& file)
+{
+  usint header[3];
+  file.read((char*)header, sizeof(header));
+  this->rank_rate = header[0];
+  this->rank_index = new ReadBuffer(file, header[1], header[2]);
+  file.read((char*)header, sizeof(header));
+  this->select_rate = header[0];
+  this->select_index = new ReadBuffer(file, header[1], header[2]);
+}
+
+void
+BitVector::readIndexes(FileMap& file)
+{
+  this->rank_rate = file.readWord();
+  usint items = file.readWord(), item_size = file.readWord();
+  this->rank_index = new ReadBuffer(file, items, item_size);
+  this->select_rate = file.readWord();
+  items = file.readWord(); item_size = file.readWord();
+  this->select_index = new ReadBuffer(file, items, item_size);
+}
+
 //--------------------------------------------------------------------------
 
 void
@@ -205,7 +276,8 @@ usint
 BitVector::reportSize() const
 {
   // We assume the reportSize() of derived classes includes any class variables of BitVector.
-  usint bytes = this->block_size * this->number_of_blocks * sizeof(usint);
+  usint bytes = 0;
+  if(this->delete_array) { bytes += this->block_size * this->number_of_blocks * sizeof(usint); }
   if(this->samples != 0) { bytes += this->samples->reportSize(); }
   if(this->rank_index != 0) { bytes += this->rank_index->reportSize(); }
   if(this->select_index != 0) { bytes += this->select_index->reportSize(); }
@@ -218,6 +290,14 @@ BitVector::getCompressedSize() const
   return this->block_size * this->number_of_blocks * sizeof(usint);
 }
 
+usint
+BitVector::checksum(usint hash) const
+{
+  usint header[2] = { this->size, this->items };
+  hash = hashWords(header, 2, hash);
+  return hashWords(this->array, this->block_size * this->number_of_blocks, hash);
+}
+
 //--------------------------------------------------------------------------
 
 void
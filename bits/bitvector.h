@@ -77,8 +77,11 @@ class BitVector
   public:
     static const usint INDEX_RATE = 5;
 
-    explicit BitVector(std::ifstream& file);
+    // If stored_indexes is true, the rank/select indexes are read after the vector
+    // instead of being rebuilt.
+    explicit BitVector(std::ifstream& file, bool stored_indexes = false);
     explicit BitVector(FILE* file);
+    explicit BitVector(FileMap& file, bool stored_indexes = false);  // The array points to the mapped file.
     BitVector(VectorEncoder& encoder, usint universe_size);
     explicit BitVector(WriteBuffer& vector);
     ~BitVector();
@@ -88,6 +91,9 @@ class BitVector
     void writeTo(std::ofstream& file) const;
     void writeTo(FILE* file) const;
 
+    // Writes the rank/select indexes for loading with stored_indexes.
+    void writeIndexesTo(std::ofstream& file) const;
+
     inline usint getSize() const { return this->size; }
     inline usint getNumberOfItems() const { return this->items; }
     inline usint getBlockSize() const { return this->block_size; }
@@ -97,6 +103,9 @@ class BitVector
 
     usint getCompressedSize() const;
 
+    // Hash of the size, the number of items, and the encoded array.
+    usint checksum(usint hash) const;
+
     // Removes structures not necessary for merging.
     void strip();
 
@@ -199,6 +208,7 @@ class BitVector
     usint size, items;
 
     const usint* array;
+    bool         delete_array;  // Do we own the array?
     usint        block_size;
     usint        number_of_blocks;
 
@@ -230,8 +240,12 @@ class BitVector
     void writeArray(FILE* file) const;
     void readHeader(std::ifstream& file);
     void readHeader(FILE* file);
+    void readHeader(FileMap& file);
     void readArray(std::ifstream& file);
     void readArray(FILE* file);
+    void readArray(FileMap& file);
+    void readIndexes(std::ifstream& file);
+    void readIndexes(FileMap& file);
 
     void copyArray(VectorEncoder& encoder, bool use_directly = false);
 
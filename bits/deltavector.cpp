@@ -7,8 +7,8 @@ namespace CSA
 {
 
 
-DeltaVector::DeltaVector(std::ifstream& file) :
-  BitVector(file)
+DeltaVector::DeltaVector(std::ifstream& file, bool stored_indexes) :
+  BitVector(file, stored_indexes)
 {
 }
 
@@ -17,6 +17,11 @@ DeltaVector::DeltaVector(FILE* file) :
 {
 }
 
+DeltaVector::DeltaVector(FileMap& file, bool stored_indexes) :
+  BitVector(file, stored_indexes)
+{
+}
+
 DeltaVector::DeltaVector(Encoder& encoder, usint universe_size) :
   BitVector(encoder, universe_size)
 {
@@ -43,8 +43,9 @@ class DeltaVector : public BitVector
   public:
     typedef DeltaEncoder Encoder;
 
-    explicit DeltaVector(std::ifstream& file);
+    explicit DeltaVector(std::ifstream& file, bool stored_indexes = false);
     explicit DeltaVector(FILE* file);
+    explicit DeltaVector(FileMap& file, bool stored_indexes = false);
     DeltaVector(Encoder& encoder, usint universe_size);
     ~DeltaVector();
 
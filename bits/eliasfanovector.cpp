@@ -0,0 +1,454 @@
+#include <cstring>
+
+#include "eliasfanovector.h"
+#include "../misc/utils.h"
+
+
+namespace CSA
+{
+
+
+// Returns the position of the (k + 1)-th 1-bit in the word.
+inline usint
+selectInWord(usint word, usint k)
+{
+  for(; k > 0; k--) { word &= ~(((usint)1 << (WORD_BITS - 1)) >> leadingZeros(word)); }
+  return leadingZeros(word);
+}
+
+//--------------------------------------------------------------------------
+
+EliasFanoVector::EliasFanoVector(std::ifstream& file, bool stored_indexes) :
+  BitVector(),
+  low_values(0)
+{
+  this->readHeader(file);
+  this->readArray(file);
+
+  this->setLowBits();
+  if(this->low_bits > 0) { this->low_values = new ReadBuffer(file, this->items, this->low_bits); }
+
+  this->integer_bits = length(this->size);
+  if(stored_indexes) { this->readIndexes(file); return; }
+  this->indexForRank();
+  this->indexForSelect();
+}
+
+EliasFanoVector::EliasFanoVector(FILE* file) :
+  BitVector(),
+  low_values(0)
+{
+  if(file == 0) { return; }
+
+  this->readHeader(file);
+  this->readArray(file);
+
+  this->setLowBits();
+  if(this->low_bits > 0) { this->low_values = new ReadBuffer(file, this->items, this->low_bits); }
+
+  this->integer_bits = length(this->size);
+  this->indexForRank();
+  this->indexForSelect();
+}
+
+EliasFanoVector::EliasFanoVector(FileMap& file, bool stored_indexes) :
+  BitVector(),
+  low_values(0)
+{
+  this->readHeader(file);
+  this->readArray(file);
+  if(!(file.isOk())) { return; }
+
+  this->setLowBits();
+  if(this->low_bits > 0) { this->low_values = new ReadBuffer(file, this->items, this->low_bits); }
+
+  this->integer_bits = length(this->size);
+  if(stored_indexes) { this->readIndexes(file); return; }
+  if(!(file.isOk())) { return; }
+  this->indexForRank();
+  this->indexForSelect();
+}
+
+EliasFanoVector::EliasFanoVector(Encoder& encoder, usint universe_size) :
+  BitVector(),
+  low_values(0)
+{
+  if(encoder.items == 0)
+  {
+    std::cerr << "EliasFanoVector: Cannot create a bit vector with no 1-bits!" << std::endl;
+    return;
+  }
+  RLEVector runs(encoder, universe_size);
+  this->encode(runs);
+}
+
+EliasFanoVector::EliasFanoVector(const RLEVector& vector) :
+  BitVector(),
+  low_values(0)
+{
+  this->encode(vector);
+}
+
+EliasFanoVector::~EliasFanoVector()
+{
+  delete this->low_values;
+}
+
+//--------------------------------------------------------------------------
+
+void
+EliasFanoVector::writeTo(std::ofstream& file) const
+{
+  this->writeHeader(file);
+  this->writeArray(file);
+  if(this->low_values != 0) { this->low_values->writeBuffer(file); }
+}
+
+void
+EliasFanoVector::writeTo(FILE* file) const
+{
+  this->writeHeader(file);
+  this->writeArray(file);
+  if(this->low_values != 0) { this->low_values->writeBuffer(file); }
+}
+
+usint
+EliasFanoVector::reportSize() const
+{
+  usint bytes = sizeof(*this);
+  bytes += BitVector::reportSize();
+  if(this->low_values != 0) { bytes += this->low_values->reportSize(); }
+  return bytes;
+}
+
+usint
+EliasFanoVector::getCompressedSize() const
+{
+  usint bytes = BitVector::getCompressedSize();
+  if(this->low_values != 0) { bytes += BITS_TO_WORDS(this->items * this->low_bits) * sizeof(usint); }
+  return bytes;
+}
+
+usint
+EliasFanoVector::checksum(usint hash) const
+{
+  hash = BitVector::checksum(hash);
+  if(this->low_values != 0) { hash = this->low_values->checksum(hash); }
+  return hash;
+}
+
+//--------------------------------------------------------------------------
+
+void
+EliasFanoVector::setLowBits()
+{
+  this->low_bits = (this->size > this->items ? length(this->size / this->items) - 1 : 0);
+  this->upper_bits = this->items + (this->size >> this->low_bits) + 1;
+}
+
+void
+EliasFanoVector::encode(const RLEVector& vector)
+{
+  this->size = vector.getSize();
+  this->items = vector.getNumberOfItems();
+  this->block_size = vector.getBlockSize();
+  this->setLowBits();
+  this->number_of_blocks = (this->upper_bits + this->block_size * WORD_BITS - 1) / (this->block_size * WORD_BITS);
+
+  usint words = this->block_size * this->number_of_blocks;
+  usint* array_buffer = new usint[words];
+  memset(array_buffer, 0, words * sizeof(usint));
+  WriteBuffer upper(array_buffer, words);
+  WriteBuffer* lower = (this->low_bits > 0 ? new WriteBuffer(this->items, this->low_bits) : 0);
+
+  RLEVector::Iterator iter(vector);
+  pair_type run = iter.selectRun(0, this->items);
+  for(usint index = 0; ; run = iter.selectNextRun(this->items))
+  {
+    for(usint i = 0; i <= run.second; i++, index++)
+    {
+      usint value = run.first + i;
+      upper.setBit((value >> this->low_bits) + index);
+      if(lower != 0) { lower->writeItem(GET(value, this->low_bits)); }
+    }
+    if(!iter.hasNext()) { break; }
+  }
+
+  this->array = array_buffer;
+  if(lower != 0)
+  {
+    this->low_values = lower->getReadBuffer();
+    delete lower;
+  }
+
+  this->integer_bits = length(this->size);
+  this->indexForRank();
+  this->indexForSelect();
+}
+
+usint
+EliasFanoVector::selectOne(usint index) const
+{
+  usint position = this->select_index->readItemConst(index / this->select_rate);
+  index %= this->select_rate;
+
+  usint word = position / WORD_BITS;
+  usint data = this->array[word] & (WORD_MAX >> (position % WORD_BITS));
+  for(usint count = popcount(data); count <= index; count = popcount(data))
+  {
+    index -= count; word++; data = this->array[word];
+  }
+
+  return word * WORD_BITS + selectInWord(data, index);
+}
+
+usint
+EliasFanoVector::selectZero(usint index) const
+{
+  usint position = this->rank_index->readItemConst(index / this->rank_rate);
+  index %= this->rank_rate;
+
+  usint word = position / WORD_BITS;
+  usint data = ~(this->array[word]) & (WORD_MAX >> (position % WORD_BITS));
+  for(usint count = popcount(data); count <= index; count = popcount(data))
+  {
+    index -= count; word++; data = ~(this->array[word]);
+  }
+
+  return word * WORD_BITS + selectInWord(data, index);
+}
+
+usint
+EliasFanoVector::nextOne(usint position) const
+{
+  usint word = position / WORD_BITS;
+  usint data = this->array[word] & (WORD_MAX >> (position % WORD_BITS));
+  while(data == 0) { word++; data = this->array[word]; }
+  return word * WORD_BITS + leadingZeros(data);
+}
+
+void
+EliasFanoVector::indexForRank()
+{
+  delete this->rank_index; this->rank_index = 0;
+
+  this->rank_rate = EliasFanoVector::SELECT_SAMPLE_RATE;
+  usint zeros = this->upper_bits - this->items;
+  WriteBuffer buffer((zeros + this->rank_rate - 1) / this->rank_rate, length(this->upper_bits));
+
+  usint count = 0;
+  for(usint word = 0; word * WORD_BITS < this->upper_bits; word++)
+  {
+    usint data = ~(this->array[word]);
+    while(data != 0)
+    {
+      usint bit = leadingZeros(data);
+      if(word * WORD_BITS + bit >= this->upper_bits) { break; }
+      if(count % this->rank_rate == 0) { buffer.writeItem(word * WORD_BITS + bit); }
+      count++;
+      data &= ~(((usint)1 << (WORD_BITS - 1)) >> bit);
+    }
+  }
+
+  this->rank_index = buffer.getReadBuffer();
+}
+
+void
+EliasFanoVector::indexForSelect()
+{
+  delete this->select_index; this->select_index = 0;
+
+  this->select_rate = EliasFanoVector::SELECT_SAMPLE_RATE;
+  WriteBuffer buffer((this->items + this->select_rate - 1) / this->select_rate, length(this->upper_bits));
+
+  usint count = 0;
+  for(usint word = 0; word * WORD_BITS < this->upper_bits; word++)
+  {
+    usint data = this->array[word];
+    while(data != 0)
+    {
+      usint bit = leadingZeros(data);
+      if(count % this->select_rate == 0) { buffer.writeItem(word * WORD_BITS + bit); }
+      count++;
+      data &= ~(((usint)1 << (WORD_BITS - 1)) >> bit);
+    }
+  }
+
+  this->select_index = buffer.getReadBuffer();
+}
+
+//--------------------------------------------------------------------------
+
+EliasFanoVector::Iterator::Iterator(const EliasFanoVector& par) :
+  parent(par),
+  cur(0), val(0), pos(0)
+{
+}
+
+EliasFanoVector::Iterator::~Iterator()
+{
+}
+
+usint
+EliasFanoVector::Iterator::rank(usint value, bool at_least)
+{
+  if(value >= this->parent.size) { return this->parent.items; }
+  if(at_least) { return this->countItems(value, false) + 1; }
+  return this->countItems(value, true);
+}
+
+usint
+EliasFanoVector::Iterator::select(usint index)
+{
+  const EliasFanoVector& par = this->parent;
+  if(index >= par.items) { return par.size; }
+
+  this->cur = index;
+  this->pos = par.selectOne(index);
+  this->val = ((this->pos - index) << par.low_bits) | par.lowValue(index);
+
+  return this->val;
+}
+
+usint
+EliasFanoVector::Iterator::selectNext()
+{
+  const EliasFanoVector& par = this->parent;
+  if(this->cur + 1 >= par.items)
+  {
+    this->cur = par.items; this->val = par.size;
+    return this->val;
+  }
+
+  this->cur++;
+  this->pos = par.nextOne(this->pos + 1);
+  this->val = ((this->pos - this->cur) << par.low_bits) | par.lowValue(this->cur);
+
+  return this->val;
+}
+
+pair_type
+EliasFanoVector::Iterator::valueBefore(usint value)
+{
+  const EliasFanoVector& par = this->parent;
+  if(value >= par.size) { return pair_type(par.size, par.items); }
+
+  usint temp = this->countItems(value, true);
+  if(temp == 0) { return pair_type(par.size, par.items); }
+  return pair_type(this->select(temp - 1), temp - 1);
+}
+
+pair_type
+EliasFanoVector::Iterator::valueAfter(usint value)
+{
+  const EliasFanoVector& par = this->parent;
+  if(value >= par.size) { return pair_type(par.size, par.items); }
+
+  usint temp = this->countItems(value, false);
+  if(temp >= par.items) { return pair_type(par.size, par.items); }
+
+  this->cur = temp;
+  this->pos = par.nextOne(this->pos);
+  this->val = ((this->pos - temp) << par.low_bits) | par.lowValue(temp);
+
+  return pair_type(this->val, this->cur);
+}
+
+pair_type
+EliasFanoVector::Iterator::nextValue()
+{
+  usint temp = this->selectNext();
+  return pair_type(temp, this->cur);
+}
+
+pair_type
+EliasFanoVector::Iterator::selectRun(usint index, usint max_length)
+{
+  usint value = this->select(index);
+  if(value >= this->parent.size) { return pair_type(value, 0); }
+  return pair_type(value, this->extendRun(max_length));
+}
+
+pair_type
+EliasFanoVector::Iterator::selectNextRun(usint max_length)
+{
+  usint value = this->selectNext();
+  if(value >= this->parent.size) { return pair_type(value, 0); }
+  return pair_type(value, this->extendRun(max_length));
+}
+
+bool
+EliasFanoVector::Iterator::isSet(usint value)
+{
+  if(value >= this->parent.size) { return false; }
+  return (this->valueAfter(value).first == value);
+}
+
+usint
+EliasFanoVector::Iterator::countRuns()
+{
+  usint runs = 1;
+  usint prev = this->select(0);
+  while(this->hasNext())
+  {
+    usint temp = this->selectNext();
+    if(temp != prev + 1) { runs++; }
+    prev = temp;
+  }
+  return runs;
+}
+
+usint
+EliasFanoVector::Iterator::countItems(usint value, bool inclusive)
+{
+  const EliasFanoVector& par = this->parent;
+
+  usint high = value >> par.low_bits;
+  usint low = (par.low_bits > 0 ? GET(value, par.low_bits) : 0);
+
+  // Bucket high starts after the high-th 0-bit.
+  this->pos = (high > 0 ? par.selectZero(high - 1) + 1 : 0);
+  usint result = this->pos - high;
+  if(inclusive)
+  {
+    while(par.upperBit(this->pos) && par.lowValue(result) <= low) { this->pos++; result++; }
+  }
+  else
+  {
+    while(par.upperBit(this->pos) && par.lowValue(result) < low) { this->pos++; result++; }
+  }
+
+  return result;
+}
+
+usint
+EliasFanoVector::Iterator::extendRun(usint max_length)
+{
+  const EliasFanoVector& par = this->parent;
+
+  usint len = 0;
+  while(len < max_length && this->cur + 1 < par.items)
+  {
+    usint next_pos = par.nextOne(this->pos + 1);
+    usint next_val = ((next_pos - this->cur - 1) << par.low_bits) | par.lowValue(this->cur + 1);
+    if(next_val != this->val + 1) { break; }
+    this->cur++; this->pos = next_pos; this->val = next_val;
+    len++;
+  }
+
+  return len;
+}
+
+//--------------------------------------------------------------------------
+
+EliasFanoEncoder::EliasFanoEncoder(usint block_bytes, usint superblock_size) :
+  RLEEncoder(block_bytes, superblock_size)
+{
+}
+
+EliasFanoEncoder::~EliasFanoEncoder()
+{
+}
+
+
+} // namespace CSA
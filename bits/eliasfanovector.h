@@ -0,0 +1,156 @@
+#ifndef ELIASFANOVECTOR_H
+#define ELIASFANOVECTOR_H
+
+#include <fstream>
+
+#include "rlevector.h"
+
+
+namespace CSA
+{
+
+
+/*
+  This class is used to construct an EliasFanoVector.
+  The number of low bits depends on the final universe size and item count, so the
+  encoder collects the 1-bits as a run-length encoded vector. Recoding happens in
+  the constructor of EliasFanoVector.
+*/
+
+class EliasFanoEncoder : public RLEEncoder
+{
+  public:
+    EliasFanoEncoder(usint block_bytes, usint superblock_size = VectorEncoder::SUPERBLOCK_SIZE);
+    ~EliasFanoEncoder();
+
+  protected:
+
+    // These are not allowed.
+    EliasFanoEncoder();
+    EliasFanoEncoder(const EliasFanoEncoder&);
+    EliasFanoEncoder& operator = (const EliasFanoEncoder&);
+};
+
+
+/*
+  This is an Elias-Fano coded bit vector. Value i = (high << low_bits) | low is stored
+  by writing low into an array of fixed-size items and setting bit high + rank(i) - 1
+  in the upper bit array. Select is a sampled select on the upper bits followed by a
+  short word scan, while rank uses a sampled select on the 0-bits.
+
+  The vector does not compress runs. Use it for Psi of collections that are not
+  repetitive enough for RLEVector to pay off.
+*/
+
+class EliasFanoVector : public BitVector
+{
+  public:
+    typedef EliasFanoEncoder Encoder;
+
+    const static usint SELECT_SAMPLE_RATE = 64;
+
+    explicit EliasFanoVector(std::ifstream& file, bool stored_indexes = false);
+    explicit EliasFanoVector(FILE* file);
+    explicit EliasFanoVector(FileMap& file, bool stored_indexes = false);
+    EliasFanoVector(Encoder& encoder, usint universe_size);
+    explicit EliasFanoVector(const RLEVector& vector);  // Recode a run-length encoded vector.
+    ~EliasFanoVector();
+
+//--------------------------------------------------------------------------
+
+    void writeTo(std::ofstream& file) const;
+    void writeTo(FILE* file) const;
+
+    usint reportSize() const;
+    usint getCompressedSize() const;
+    usint checksum(usint hash) const;
+
+    // Both indexes are required for queries.
+    void strip() {}
+
+//--------------------------------------------------------------------------
+
+    class Iterator
+    {
+      public:
+        explicit Iterator(const EliasFanoVector& par);
+        ~Iterator();
+
+        usint rank(usint value, bool at_least = false);
+
+        usint select(usint index);
+        usint selectNext();
+        inline bool hasNext() const { return (this->cur + 1 < this->parent.items); }
+
+        pair_type valueBefore(usint value);
+        pair_type valueAfter(usint value);
+        pair_type nextValue();
+
+        pair_type selectRun(usint index, usint max_length);
+        pair_type selectNextRun(usint max_length);
+
+        bool isSet(usint value);
+
+        usint countRuns();
+
+      protected:
+        const EliasFanoVector& parent;
+
+        // pos is the position of the current item in the upper bit array.
+        usint cur, val, pos;
+
+        // Returns the number of items < value (<= value if inclusive) and leaves pos
+        // at the position in the upper bit array following the last such item.
+        usint countItems(usint value, bool inclusive);
+
+        // Extends the current item into a run of at most max_length extra items.
+        usint extendRun(usint max_length);
+
+        // These are not allowed.
+        Iterator();
+        Iterator(const Iterator&);
+        Iterator& operator = (const Iterator&);
+    };
+
+//--------------------------------------------------------------------------
+
+  protected:
+    usint       low_bits;
+    ReadBuffer* low_values;   // 0 if low_bits == 0.
+    usint       upper_bits;   // Length of the upper bit array.
+
+    inline usint lowValue(usint index) const
+    {
+      return (this->low_bits > 0 ? this->low_values->readItemConst(index) : 0);
+    }
+
+    inline bool upperBit(usint position) const
+    {
+      return (this->array[position / WORD_BITS] & ((usint)1 << (WORD_BITS - position % WORD_BITS - 1)));
+    }
+
+    // Positions of the (i + 1)-th 1-bit and 0-bit in the upper bit array.
+    usint selectOne(usint index) const;
+    usint selectZero(usint index) const;
+
+    // Position of the first 1-bit at or after position in the upper bit array.
+    usint nextOne(usint position) const;
+
+    void setLowBits();
+    void encode(const RLEVector& vector);
+
+    // rank_index samples every select_rate-th 0-bit, select_index every select_rate-th 1-bit.
+    void indexForRank();
+    void indexForSelect();
+
+    // These are not allowed.
+    EliasFanoVector();
+    EliasFanoVector(const EliasFanoVector&);
+    EliasFanoVector& operator = (const EliasFanoVector&);
+};
+
+
+} // namespace CSA
+
+
+#endif // ELIASFANOVECTOR_H
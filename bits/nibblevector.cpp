@@ -8,8 +8,8 @@ namespace CSA
 {
 
 
-NibbleVector::NibbleVector(std::ifstream& file) :
-  BitVector(file)
+NibbleVector::NibbleVector(std::ifstream& file, bool stored_indexes) :
+  BitVector(file, stored_indexes)
 {
 }
 
@@ -18,6 +18,11 @@ NibbleVector::NibbleVector(FILE* file) :
 {
 }
 
+NibbleVector::NibbleVector(FileMap& file, bool stored_indexes) :
+  BitVector(file, stored_indexes)
+{
+}
+
 NibbleVector::NibbleVector(Encoder& encoder, usint universe_size) :
   BitVector(encoder, universe_size)
 {
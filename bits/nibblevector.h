@@ -58,8 +58,9 @@ class NibbleVector : public BitVector
   public:
     typedef NibbleEncoder Encoder;
 
-    explicit NibbleVector(std::ifstream& file);
+    explicit NibbleVector(std::ifstream& file, bool stored_indexes = false);
     explicit NibbleVector(FILE* file);
+    explicit NibbleVector(FileMap& file, bool stored_indexes = false);
     NibbleVector(Encoder& encoder, usint universe_size);
     ~NibbleVector();
 
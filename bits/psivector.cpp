@@ -0,0 +1,239 @@
+#include <new>
+
+#include "psivector.h"
+
+
+namespace CSA
+{
+
+
+#if defined(USE_NIBBLE_VECTORS)
+usint PsiVector::default_encoding = PsiVector::NIBBLE;
+#elif defined(USE_ELIAS_FANO_VECTORS)
+usint PsiVector::default_encoding = PsiVector::ELIAS_FANO;
+#else
+usint PsiVector::default_encoding = PsiVector::AUTOMATIC;
+#endif
+
+
+PsiVector::PsiVector(std::ifstream& file, usint _encoding, bool stored_indexes) :
+  encoding(_encoding), vector(0)
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     this->vector = new NibbleVector(file, stored_indexes); break;
+    case ELIAS_FANO: this->vector = new EliasFanoVector(file, stored_indexes); break;
+    default:         this->encoding = RLE; this->vector = new RLEVector(file, stored_indexes); break;
+  }
+}
+
+PsiVector::PsiVector(FILE* file, usint _encoding) :
+  encoding(_encoding), vector(0)
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     this->vector = new NibbleVector(file); break;
+    case ELIAS_FANO: this->vector = new EliasFanoVector(file); break;
+    default:         this->encoding = RLE; this->vector = new RLEVector(file); break;
+  }
+}
+
+PsiVector::PsiVector(FileMap& file, usint _encoding, bool stored_indexes) :
+  encoding(_encoding), vector(0)
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     this->vector = new NibbleVector(file, stored_indexes); break;
+    case ELIAS_FANO: this->vector = new EliasFanoVector(file, stored_indexes); break;
+    default:         this->encoding = RLE; this->vector = new RLEVector(file, stored_indexes); break;
+  }
+}
+
+PsiVector::PsiVector(Encoder& encoder, usint universe_size) :
+  encoding(RLE), vector(0)
+{
+  this->encode(new RLEVector(encoder, universe_size), default_encoding);
+}
+
+PsiVector::PsiVector(Encoder& encoder, usint universe_size, usint _encoding) :
+  encoding(RLE), vector(0)
+{
+  this->encode(new RLEVector(encoder, universe_size), _encoding);
+}
+
+PsiVector::~PsiVector()
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     delete (NibbleVector*)(this->vector); break;
+    case ELIAS_FANO: delete (EliasFanoVector*)(this->vector); break;
+    default:         delete (RLEVector*)(this->vector); break;
+  }
+}
+
+//--------------------------------------------------------------------------
+
+void
+PsiVector::writeTo(std::ofstream& file) const
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     ((NibbleVector*)(this->vector))->writeTo(file); break;
+    case ELIAS_FANO: ((EliasFanoVector*)(this->vector))->writeTo(file); break;
+    default:         ((RLEVector*)(this->vector))->writeTo(file); break;
+  }
+}
+
+void
+PsiVector::writeTo(FILE* file) const
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     ((NibbleVector*)(this->vector))->writeTo(file); break;
+    case ELIAS_FANO: ((EliasFanoVector*)(this->vector))->writeTo(file); break;
+    default:         ((RLEVector*)(this->vector))->writeTo(file); break;
+  }
+}
+
+usint
+PsiVector::reportSize() const
+{
+  usint bytes = sizeof(*this);
+  switch(this->encoding)
+  {
+    case NIBBLE:     bytes += ((NibbleVector*)(this->vector))->reportSize(); break;
+    case ELIAS_FANO: bytes += ((EliasFanoVector*)(this->vector))->reportSize(); break;
+    default:         bytes += ((RLEVector*)(this->vector))->reportSize(); break;
+  }
+  return bytes;
+}
+
+usint
+PsiVector::getCompressedSize() const
+{
+  if(this->encoding == ELIAS_FANO) { return ((EliasFanoVector*)(this->vector))->getCompressedSize(); }
+  return this->vector->getCompressedSize();
+}
+
+usint
+PsiVector::checksum(usint hash) const
+{
+  if(this->encoding == ELIAS_FANO) { return ((EliasFanoVector*)(this->vector))->checksum(hash); }
+  return this->vector->checksum(hash);
+}
+
+void
+PsiVector::strip()
+{
+  if(this->encoding == ELIAS_FANO) { return; }
+  this->vector->strip();
+}
+
+const char*
+PsiVector::encodingName(usint _encoding)
+{
+  switch(_encoding)
+  {
+    case RLE:        return "RLE";
+    case NIBBLE:     return "Nibble";
+    case ELIAS_FANO: return "Elias-Fano";
+    case MIXED:      return "Mixed";
+    case AUTOMATIC:  return "Automatic";
+    default:         return "Unknown";
+  }
+}
+
+usint
+PsiVector::getDefaultEncoding()
+{
+  return default_encoding;
+}
+
+void
+PsiVector::setDefaultEncoding(usint _encoding)
+{
+  if(isValidEncoding(_encoding) || _encoding == AUTOMATIC) { default_encoding = _encoding; }
+}
+
+//--------------------------------------------------------------------------
+
+void
+PsiVector::encode(RLEVector* runs, usint _encoding)
+{
+  if(_encoding == AUTOMATIC)
+  {
+    // The size of the run-length encoding reflects the number and the lengths of the runs.
+    usint items = runs->getNumberOfItems(), size = runs->getSize();
+    usint low_bits = (size > items ? length(size / items) - 1 : 0);
+    usint ef_bytes = BITS_TO_BYTES(items * (low_bits + 2) + (size >> low_bits) + 1);
+    usint rle_bytes = runs->getCompressedSize();
+    _encoding = (4 * ef_bytes <= 5 * rle_bytes ? ELIAS_FANO : RLE);
+  }
+
+  switch(_encoding)
+  {
+    case NIBBLE:
+      {
+        NibbleEncoder encoder(runs->getBlockSize() * sizeof(usint));
+        RLEVector::Iterator iter(*runs);
+        pair_type run = iter.selectRun(0, runs->getNumberOfItems());
+        while(true)
+        {
+          encoder.setRun(run.first, run.second + 1);
+          if(!iter.hasNext()) { break; }
+          run = iter.selectNextRun(runs->getNumberOfItems());
+        }
+        encoder.flush();
+        this->vector = new NibbleVector(encoder, runs->getSize());
+        delete runs;
+        this->encoding = NIBBLE;
+      }
+      break;
+    case ELIAS_FANO:
+      this->vector = new EliasFanoVector(*runs);
+      delete runs;
+      this->encoding = ELIAS_FANO;
+      break;
+    default:
+      this->vector = runs;
+      this->encoding = RLE;
+      break;
+  }
+}
+
+//--------------------------------------------------------------------------
+
+PsiVector::Iterator::Iterator(const PsiVector& par) :
+  encoding(par.encoding)
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     new(this->storage) NibbleVector::Iterator(*(NibbleVector*)(par.vector)); break;
+    case ELIAS_FANO: new(this->storage) EliasFanoVector::Iterator(*(EliasFanoVector*)(par.vector)); break;
+    default:         new(this->storage) RLEVector::Iterator(*(RLEVector*)(par.vector)); break;
+  }
+}
+
+PsiVector::Iterator::~Iterator()
+{
+  switch(this->encoding)
+  {
+    case NIBBLE:     this->nibble().~Iterator(); break;
+    case ELIAS_FANO: this->eliasFano().~Iterator(); break;
+    default:         this->rle().~Iterator(); break;
+  }
+}
+
+//--------------------------------------------------------------------------
+
+PsiEncoder::PsiEncoder(usint block_bytes, usint superblock_size) :
+  RLEEncoder(block_bytes, superblock_size)
+{
+}
+
+PsiEncoder::~PsiEncoder()
+{
+}
+
+
+} // namespace CSA
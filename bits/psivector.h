@@ -0,0 +1,169 @@
+#ifndef PSIVECTOR_H
+#define PSIVECTOR_H
+
+#include <cstdio>
+#include <fstream>
+
+#include "rlevector.h"
+#include "nibblevector.h"
+#include "eliasfanovector.h"
+
+
+namespace CSA
+{
+
+
+/*
+  This class is used to construct a PsiVector.
+  The 1-bits are collected as a run-length encoded vector, and the final encoding
+  is chosen when the PsiVector is built.
+*/
+
+class PsiEncoder : public RLEEncoder
+{
+  public:
+    PsiEncoder(usint block_bytes, usint superblock_size = VectorEncoder::SUPERBLOCK_SIZE);
+    ~PsiEncoder();
+
+  protected:
+
+    // These are not allowed.
+    PsiEncoder();
+    PsiEncoder(const PsiEncoder&);
+    PsiEncoder& operator = (const PsiEncoder&);
+};
+
+
+/*
+  A bit vector for Psi using one of the available encodings.
+  The encoding is chosen at run time, separately for each vector.
+*/
+
+class PsiVector
+{
+  public:
+    typedef PsiEncoder Encoder;
+
+    // These values are stored on disk.
+    const static usint RLE        = 0;
+    const static usint NIBBLE     = 1;
+    const static usint ELIAS_FANO = 2;
+    const static usint MIXED      = 3; // Each vector is preceded by its encoding.
+    const static usint AUTOMATIC  = 4; // Used only when building.
+
+    PsiVector(std::ifstream& file, usint _encoding, bool stored_indexes = false);
+    PsiVector(FILE* file, usint _encoding);
+    PsiVector(FileMap& file, usint _encoding, bool stored_indexes = false);
+
+    // The encoding is chosen using getDefaultEncoding().
+    PsiVector(Encoder& encoder, usint universe_size);
+    PsiVector(Encoder& encoder, usint universe_size, usint _encoding);
+    ~PsiVector();
+
+//--------------------------------------------------------------------------
+
+    void writeTo(std::ofstream& file) const;
+    void writeTo(FILE* file) const;
+    inline void writeIndexesTo(std::ofstream& file) const { this->vector->writeIndexesTo(file); }
+
+    inline usint getEncoding() const { return this->encoding; }
+    inline usint getSize() const { return this->vector->getSize(); }
+    inline usint getNumberOfItems() const { return this->vector->getNumberOfItems(); }
+    inline usint getBlockSize() const { return this->vector->getBlockSize(); }
+
+    usint reportSize() const;
+    usint getCompressedSize() const;
+
+    // Hash of the encoded vector. The same vector has different hashes in different encodings.
+    usint checksum(usint hash) const;
+
+    // Removes structures not necessary for merging.
+    void strip();
+
+    static bool isValidEncoding(usint _encoding) { return (_encoding <= ELIAS_FANO); }
+    static const char* encodingName(usint _encoding);
+
+    /*
+      The encoding used for new vectors. Defaults to AUTOMATIC, unless overridden by
+      USE_NIBBLE_VECTORS or USE_ELIAS_FANO_VECTORS.
+      AUTOMATIC uses RLE, unless Elias-Fano is at most 25% larger.
+    */
+    static usint getDefaultEncoding();
+    static void setDefaultEncoding(usint _encoding);
+
+//--------------------------------------------------------------------------
+
+    class Iterator
+    {
+      public:
+        explicit Iterator(const PsiVector& par);
+        ~Iterator();
+
+        #define PSI_DISPATCH(CALL) \
+          switch(this->encoding) \
+          { \
+            case PsiVector::NIBBLE:     return this->nibble().CALL; \
+            case PsiVector::ELIAS_FANO: return this->eliasFano().CALL; \
+            default:                    return this->rle().CALL; \
+          }
+
+        inline usint rank(usint value, bool at_least = false) { PSI_DISPATCH(rank(value, at_least)) }
+
+        inline usint select(usint index) { PSI_DISPATCH(select(index)) }
+        inline usint selectNext() { PSI_DISPATCH(selectNext()) }
+        inline bool hasNext() { PSI_DISPATCH(hasNext()) }
+
+        inline pair_type valueBefore(usint value) { PSI_DISPATCH(valueBefore(value)) }
+        inline pair_type valueAfter(usint value) { PSI_DISPATCH(valueAfter(value)) }
+        inline pair_type nextValue() { PSI_DISPATCH(nextValue()) }
+
+        inline pair_type selectRun(usint index, usint max_length) { PSI_DISPATCH(selectRun(index, max_length)) }
+        inline pair_type selectNextRun(usint max_length) { PSI_DISPATCH(selectNextRun(max_length)) }
+
+        inline bool isSet(usint value) { PSI_DISPATCH(isSet(value)) }
+
+        inline usint countRuns() { PSI_DISPATCH(countRuns()) }
+
+        #undef PSI_DISPATCH
+
+      protected:
+        #define PSI_MAX(A, B) ((A) > (B) ? (A) : (B))
+        const static usint STORAGE_WORDS =
+          BYTES_TO_WORDS(PSI_MAX(sizeof(RLEVector::Iterator), PSI_MAX(sizeof(NibbleVector::Iterator), sizeof(EliasFanoVector::Iterator))));
+        #undef PSI_MAX
+
+        // The actual iterator is constructed in storage to avoid heap allocation.
+        usint encoding;
+        usint storage[STORAGE_WORDS];
+
+        inline RLEVector::Iterator& rle() { return *(RLEVector::Iterator*)(this->storage); }
+        inline NibbleVector::Iterator& nibble() { return *(NibbleVector::Iterator*)(this->storage); }
+        inline EliasFanoVector::Iterator& eliasFano() { return *(EliasFanoVector::Iterator*)(this->storage); }
+
+        // These are not allowed.
+        Iterator();
+        Iterator(const Iterator&);
+        Iterator& operator = (const Iterator&);
+    };
+
+//--------------------------------------------------------------------------
+
+  protected:
+    usint      encoding;
+    BitVector* vector;
+
+    static usint default_encoding;
+
+    void encode(RLEVector* runs, usint _encoding);
+
+    // These are not allowed.
+    PsiVector();
+    PsiVector(const PsiVector&);
+    PsiVector& operator = (const PsiVector&);
+};
+
+
+} // namespace CSA
+
+
+#endif // PSIVECTOR_H
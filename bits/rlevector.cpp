@@ -8,8 +8,8 @@ namespace CSA
 {
 
 
-RLEVector::RLEVector(std::ifstream& file) :
-  BitVector(file)
+RLEVector::RLEVector(std::ifstream& file, bool stored_indexes) :
+  BitVector(file, stored_indexes)
 {
 }
 
@@ -18,6 +18,11 @@ RLEVector::RLEVector(FILE* file) :
 {
 }
 
+RLEVector::RLEVector(FileMap& file, bool stored_indexes) :
+  BitVector(file, stored_indexes)
+{
+}
+
 RLEVector::RLEVector(Encoder& encoder, usint universe_size) :
   BitVector(encoder, universe_size)
 {
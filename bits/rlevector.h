@@ -55,8 +55,9 @@ class RLEVector : public BitVector
   public:
     typedef RLEEncoder Encoder;
 
-    explicit RLEVector(std::ifstream& file);
+    explicit RLEVector(std::ifstream& file, bool stored_indexes = false);
     explicit RLEVector(FILE* file);
+    explicit RLEVector(FileMap& file, bool stored_indexes = false);
     RLEVector(Encoder& encoder, usint universe_size);
     ~RLEVector();
 
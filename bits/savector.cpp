@@ -0,0 +1,134 @@
+#include <new>
+
+#include "savector.h"
+
+
+namespace CSA
+{
+
+
+#ifdef SUCCINCT_SA_VECTOR
+usint SAVector::default_encoding = SAVector::SUCCINCT;
+#else
+usint SAVector::default_encoding = SAVector::DELTA;
+#endif
+
+
+SAVector::SAVector(std::ifstream& file, usint _encoding, bool stored_indexes) :
+  encoding(_encoding), vector(0)
+{
+  if(this->encoding == SUCCINCT) { this->vector = new SuccinctVector(file, stored_indexes); }
+  else { this->encoding = DELTA; this->vector = new DeltaVector(file, stored_indexes); }
+}
+
+SAVector::SAVector(FILE* file, usint _encoding) :
+  encoding(_encoding), vector(0)
+{
+  if(this->encoding == SUCCINCT) { this->vector = new SuccinctVector(file); }
+  else { this->encoding = DELTA; this->vector = new DeltaVector(file); }
+}
+
+SAVector::SAVector(FileMap& file, usint _encoding, bool stored_indexes) :
+  encoding(_encoding), vector(0)
+{
+  if(this->encoding == SUCCINCT) { this->vector = new SuccinctVector(file, stored_indexes); }
+  else { this->encoding = DELTA; this->vector = new DeltaVector(file, stored_indexes); }
+}
+
+SAVector::SAVector(Encoder& encoder, usint universe_size) :
+  encoding(default_encoding), vector(0)
+{
+  DeltaVector* gaps = new DeltaVector(encoder, universe_size);
+  if(this->encoding != SUCCINCT)
+  {
+    this->vector = gaps;
+    return;
+  }
+
+  SuccinctEncoder succinct(SUCCINCT_BLOCK_SIZE);
+  DeltaVector::Iterator iter(*gaps);
+  succinct.setBit(iter.select(0));
+  while(iter.hasNext()) { succinct.setBit(iter.selectNext()); }
+  this->vector = new SuccinctVector(succinct, universe_size);
+  delete gaps;
+}
+
+SAVector::~SAVector()
+{
+  if(this->encoding == SUCCINCT) { delete (SuccinctVector*)(this->vector); }
+  else { delete (DeltaVector*)(this->vector); }
+}
+
+//--------------------------------------------------------------------------
+
+void
+SAVector::writeTo(std::ofstream& file) const
+{
+  if(this->encoding == SUCCINCT) { ((SuccinctVector*)(this->vector))->writeTo(file); }
+  else { ((DeltaVector*)(this->vector))->writeTo(file); }
+}
+
+void
+SAVector::writeTo(FILE* file) const
+{
+  if(this->encoding == SUCCINCT) { ((SuccinctVector*)(this->vector))->writeTo(file); }
+  else { ((DeltaVector*)(this->vector))->writeTo(file); }
+}
+
+usint
+SAVector::reportSize() const
+{
+  usint bytes = sizeof(*this);
+  if(this->encoding == SUCCINCT) { bytes += ((SuccinctVector*)(this->vector))->reportSize(); }
+  else { bytes += ((DeltaVector*)(this->vector))->reportSize(); }
+  return bytes;
+}
+
+void
+SAVector::strip()
+{
+  // SuccinctVector has nothing to remove.
+  if(this->encoding == SUCCINCT) { return; }
+  this->vector->strip();
+}
+
+usint
+SAVector::getDefaultEncoding()
+{
+  return default_encoding;
+}
+
+void
+SAVector::setDefaultEncoding(usint _encoding)
+{
+  if(isValidEncoding(_encoding)) { default_encoding = _encoding; }
+}
+
+//--------------------------------------------------------------------------
+
+SAVector::Iterator::Iterator(const SAVector& par) :
+  encoding(par.encoding)
+{
+  if(this->encoding == SUCCINCT) { new(this->storage) SuccinctVector::Iterator(*(SuccinctVector*)(par.vector)); }
+  else { new(this->storage) DeltaVector::Iterator(*(DeltaVector*)(par.vector)); }
+}
+
+SAVector::Iterator::~Iterator()
+{
+  if(this->encoding == SUCCINCT) { this->succinct().~Iterator(); }
+  else { this->delta().~Iterator(); }
+}
+
+//--------------------------------------------------------------------------
+
+SAEncoder::SAEncoder(usint block_bytes, usint superblock_size) :
+  DeltaEncoder(block_bytes, superblock_size)
+{
+}
+
+SAEncoder::~SAEncoder()
+{
+}
+
+
+} // namespace CSA
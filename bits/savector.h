@@ -0,0 +1,146 @@
+#ifndef SAVECTOR_H
+#define SAVECTOR_H
+
+#include <cstdio>
+#include <fstream>
+
+#include "deltavector.h"
+#include "succinctvector.h"
+
+
+namespace CSA
+{
+
+
+/*
+  This class is used to construct an SAVector. The 1-bits must be set in increasing
+  order. They are collected as a gap encoded vector, and the vector is recoded when
+  the SAVector is built, if necessary.
+*/
+
+class SAEncoder : public DeltaEncoder
+{
+  public:
+    SAEncoder(usint block_bytes, usint superblock_size = VectorEncoder::SUPERBLOCK_SIZE);
+    ~SAEncoder();
+
+  protected:
+
+    // These are not allowed.
+    SAEncoder();
+    SAEncoder(const SAEncoder&);
+    SAEncoder& operator = (const SAEncoder&);
+};
+
+
+/*
+  A bit vector marking the sampled positions, using either gap encoding or a succinct
+  bit vector. The encoding is chosen at run time.
+*/
+
+class SAVector
+{
+  public:
+    typedef SAEncoder Encoder;
+
+    // These values are stored on disk.
+    const static usint DELTA    = 0;
+    const static usint SUCCINCT = 1;
+
+    const static usint SUCCINCT_BLOCK_SIZE = 32;
+
+    SAVector(std::ifstream& file, usint _encoding, bool stored_indexes = false);
+    SAVector(FILE* file, usint _encoding);
+    SAVector(FileMap& file, usint _encoding, bool stored_indexes = false);
+
+    // The encoding is chosen using getDefaultEncoding().
+    SAVector(Encoder& encoder, usint universe_size);
+    ~SAVector();
+
+//--------------------------------------------------------------------------
+
+    void writeTo(std::ofstream& file) const;
+    void writeTo(FILE* file) const;
+    inline void writeIndexesTo(std::ofstream& file) const { this->vector->writeIndexesTo(file); }
+
+    inline usint getEncoding() const { return this->encoding; }
+    inline usint getSize() const { return this->vector->getSize(); }
+    inline usint getNumberOfItems() const { return this->vector->getNumberOfItems(); }
+
+    usint reportSize() const;
+
+    // Removes structures not necessary for merging.
+    void strip();
+
+    static bool isValidEncoding(usint _encoding) { return (_encoding <= SUCCINCT); }
+
+    // The encoding used for new vectors. SUCCINCT_SA_VECTOR makes SUCCINCT the default.
+    static usint getDefaultEncoding();
+    static void setDefaultEncoding(usint _encoding);
+
+//--------------------------------------------------------------------------
+
+    class Iterator
+    {
+      public:
+        explicit Iterator(const SAVector& par);
+        ~Iterator();
+
+        #define SA_DISPATCH(CALL) \
+          if(this->encoding == SAVector::SUCCINCT) { return this->succinct().CALL; } \
+          return this->delta().CALL;
+
+        inline usint rank(usint value, bool at_least = false) { SA_DISPATCH(rank(value, at_least)) }
+
+        inline usint select(usint index) { SA_DISPATCH(select(index)) }
+        inline usint selectNext() { SA_DISPATCH(selectNext()) }
+        inline bool hasNext() { SA_DISPATCH(hasNext()) }
+
+        inline pair_type valueBefore(usint value) { SA_DISPATCH(valueBefore(value)) }
+        inline pair_type valueAfter(usint value) { SA_DISPATCH(valueAfter(value)) }
+        inline pair_type nextValue() { SA_DISPATCH(nextValue()) }
+
+        inline pair_type selectRun(usint index, usint max_length) { SA_DISPATCH(selectRun(index, max_length)) }
+        inline pair_type selectNextRun(usint max_length) { SA_DISPATCH(selectNextRun(max_length)) }
+
+        inline bool isSet(usint value) { SA_DISPATCH(isSet(value)) }
+
+        #undef SA_DISPATCH
+
+      protected:
+        const static usint STORAGE_WORDS =
+          BYTES_TO_WORDS(sizeof(DeltaVector::Iterator) > sizeof(SuccinctVector::Iterator) ?
+                         sizeof(DeltaVector::Iterator) : sizeof(SuccinctVector::Iterator));
+
+        // The actual iterator is constructed in storage to avoid heap allocation.
+        usint encoding;
+        usint storage[STORAGE_WORDS];
+
+        inline DeltaVector::Iterator& delta() { return *(DeltaVector::Iterator*)(this->storage); }
+        inline SuccinctVector::Iterator& succinct() { return *(SuccinctVector::Iterator*)(this->storage); }
+
+        // These are not allowed.
+        Iterator();
+        Iterator(const Iterator&);
+        Iterator& operator = (const Iterator&);
+    };
+
+//--------------------------------------------------------------------------
+
+  protected:
+    usint      encoding;
+    BitVector* vector;
+
+    static usint default_encoding;
+
+    // These are not allowed.
+    SAVector();
+    SAVector(const SAVector&);
+    SAVector& operator = (const SAVector&);
+};
+
+
+} // namespace CSA
+
+
+#endif // SAVECTOR_H
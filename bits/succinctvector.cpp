@@ -6,13 +6,14 @@ namespace CSA
 {
 
 
-SuccinctVector::SuccinctVector(std::ifstream& file) :
+SuccinctVector::SuccinctVector(std::ifstream& file, bool stored_indexes) :
   BitVector()
 {
   this->readHeader(file);
   this->readArray(file);
 
   this->integer_bits = length(this->size);
+  if(stored_indexes) { this->readIndexes(file); return; }
   this->indexForRank();
   this->indexForSelect();
 }
@@ -30,6 +31,19 @@ SuccinctVector::SuccinctVector(FILE* file) :
   this->indexForSelect();
 }
 
+SuccinctVector::SuccinctVector(FileMap& file, bool stored_indexes) :
+  BitVector()
+{
+  this->readHeader(file);
+  this->readArray(file);
+
+  this->integer_bits = length(this->size);
+  if(stored_indexes) { this->readIndexes(file); return; }
+  if(!(file.isOk())) { return; }
+  this->indexForRank();
+  this->indexForSelect();
+}
+
 SuccinctVector::SuccinctVector(Encoder& encoder, usint universe_size) :
   BitVector()
 {
@@ -107,6 +121,7 @@ SuccinctVector::indexForRank()
 {
   delete this->rank_index; this->rank_index = 0;
 
+  this->rank_rate = this->block_size * WORD_BITS;
   WriteBuffer buffer(this->number_of_blocks + 1, this->integer_bits);
   const usint* data = this->array;
 
@@ -49,8 +49,9 @@ class SuccinctVector : public BitVector
 
     typedef SuccinctEncoder Encoder;
 
-    explicit SuccinctVector(std::ifstream& file);
+    explicit SuccinctVector(std::ifstream& file, bool stored_indexes = false);
     explicit SuccinctVector(FILE* file);
+    explicit SuccinctVector(FileMap& file, bool stored_indexes = false);
     SuccinctVector(Encoder& encoder, usint universe_size);
     explicit SuccinctVector(Encoder& encoder); // Use the array directly.
     explicit SuccinctVector(WriteBuffer& vector);
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "rlcsa.h"
+#include "misc/utils.h"
+
+
+using namespace CSA;
+
+
+/*
+  This program builds the k-mer table for an existing index.
+*/
+
+
+const int MAX_THREADS = 64;
+
+
+int
+main(int argc, char** argv)
+{
+  std::cout << "k-mer table builder" << std::endl;
+  if(argc < 2)
+  {
+    std::cout << "Usage: build_kmer_table base_name [k] [threads]" << std::endl;
+    return 1;
+  }
+
+  std::string base_name = argv[1];
+  std::cout << "Base name: " << base_name << std::endl;
+  usint k = 10;
+  if(argc > 2) { k = atoi(argv[2]); }
+  std::cout << "k: " << k << std::endl;
+  usint threads = 1;
+  if(argc > 3) { threads = std::min(MAX_THREADS, std::max(atoi(argv[3]), 1)); }
+  std::cout << "Threads: " << threads << std::endl;
+  std::cout << std::endl;
+
+  RLCSA rlcsa(base_name, false, false, threads);
+  if(!(rlcsa.isOk())) { return 2; }
+
+  double start = readTimer();
+  KmerTable table(rlcsa, k, threads);
+  if(!(table.isOk())) { return 3; }
+  table.writeTo(base_name);
+  double stop = readTimer();
+
+  std::cout << table.getNumberOfKmers() << " k-mers in " << (stop - start) << " seconds" << std::endl;
+  std::cout << "Table size: " << (table.reportSize() / (double)MEGABYTE) << " MB" << std::endl;
+  std::cout << "Memory usage: " << memoryUsage() << " kB" << std::endl;
+  std::cout << std::endl;
+
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -45,6 +46,8 @@ main(int argc, char** argv)
     parameters.set(WEIGHTED_SAMPLES);
     parameters.read(parameters_name);
     parameters.print();
+    if(parameters.contains(PSI_ENCODING.first)) { PsiVector::setDefaultEncoding(parameters.get(PSI_ENCODING)); }
+    if(parameters.contains(SA_ENCODING.first)) { SAVector::setDefaultEncoding(parameters.get(SA_ENCODING)); }
 
     double start = readTimer();
     std::ifstream input(base_name.c_str(), std::ios_base::binary);
@@ -70,6 +73,9 @@ main(int argc, char** argv)
     rlcsa.printInfo();
     rlcsa.reportSize(true);
     rlcsa.writeTo(base_name);
+    std::remove((base_name + RUN_SAMPLES_EXTENSION).c_str());
+    std::remove((base_name + SAMPLE_CACHE_EXTENSION).c_str());
+    std::remove((base_name + KMER_TABLE_EXTENSION).c_str());
     double total = readTimer() - start;
 
     double megabytes = size / (double)MEGABYTE;
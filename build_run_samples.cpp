@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "rlcsa.h"
+#include "misc/utils.h"
+
+
+using namespace CSA;
+
+
+/*
+  This program builds the run samples (see runsamples.h) for an existing index.
+  The index must have been built with SA samples.
+*/
+
+
+const int MAX_THREADS = 64;
+
+
+int
+main(int argc, char** argv)
+{
+  std::cout << "Run sample builder" << std::endl;
+  if(argc < 2)
+  {
+    std::cout << "Usage: build_run_samples base_name [threads]" << std::endl;
+    return 1;
+  }
+
+  std::string base_name = argv[1];
+  std::cout << "Base name: " << base_name << std::endl;
+  usint threads = 1;
+  if(argc > 2) { threads = std::min(MAX_THREADS, std::max(atoi(argv[2]), 1)); }
+  std::cout << "Threads: " << threads << std::endl;
+  std::cout << std::endl;
+
+  RLCSA rlcsa(base_name, false, false, threads);
+  if(!(rlcsa.isOk())) { return 2; }
+
+  double start = readTimer();
+  RunSamples samples(rlcsa, threads);
+  if(!(samples.isOk())) { return 3; }
+
+  std::string sample_name = base_name + RUN_SAMPLES_EXTENSION;
+  std::ofstream sample_file(sample_name.c_str(), std::ios_base::binary);
+  if(!sample_file)
+  {
+    std::cerr << "Error creating run sample file!" << std::endl;
+    return 4;
+  }
+  samples.writeTo(sample_file);
+  sample_file.close();
+  double stop = readTimer();
+
+  std::cout << samples.getNumberOfToeholds() << " toeholds and " << samples.getNumberOfPhiSamples() << " phi samples in " << (stop - start) << " seconds" << std::endl;
+  std::cout << "Run samples: " << (samples.reportSize() / (double)MEGABYTE) << " MB" << std::endl;
+  std::cout << "Memory usage: " << memoryUsage() << " kB" << std::endl;
+  std::cout << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "rlcsa.h"
+#include "misc/utils.h"
+
+
+using namespace CSA;
+
+
+/*
+  This program builds regular SA samples for an existing index, replacing the old
+  samples if there are any. The index can be built without samples (sample rate 0)
+  and sampled later. If the sample rate changes, the sequences are padded again,
+  and the whole index is written. The run samples and the sample cache are then
+  removed, as they depend on the text positions.
+*/
+
+
+const int MAX_THREADS = 64;
+
+
+int
+main(int argc, char** argv)
+{
+  std::cout << "SA sample builder" << std::endl;
+  if(argc < 3)
+  {
+    std::cout << "Usage: build_sa_samples base_name sample_rate [threads]" << std::endl;
+    return 1;
+  }
+
+  std::string base_name = argv[1];
+  std::cout << "Base name: " << base_name << std::endl;
+  usint sample_rate = std::max(atoi(argv[2]), 1);
+  std::cout << "Sample rate: " << sample_rate << std::endl;
+  usint threads = 1;
+  if(argc > 3) { threads = std::min(MAX_THREADS, std::max(atoi(argv[3]), 1)); }
+  std::cout << "Threads: " << threads << std::endl;
+  std::cout << std::endl;
+
+  RLCSA rlcsa(base_name, false, false, threads);
+  if(!(rlcsa.isOk())) { return 2; }
+  bool positions_change = (sample_rate != rlcsa.getSampleRate());
+
+  double start = readTimer();
+  if(!(rlcsa.buildSASamples(sample_rate, threads)))
+  {
+    std::cerr << "Error building the samples!" << std::endl;
+    return 3;
+  }
+  double mark = readTimer();
+
+  if(positions_change)
+  {
+    rlcsa.writeTo(base_name);
+    std::remove((base_name + RUN_SAMPLES_EXTENSION).c_str());
+    std::remove((base_name + SAMPLE_CACHE_EXTENSION).c_str());
+    std::remove((base_name + KMER_TABLE_EXTENSION).c_str());
+  }
+  else { rlcsa.writeSamplesTo(base_name); }
+  double stop = readTimer();
+
+  std::cout << rlcsa.getSASamples()->getNumberOfSamples() << " samples built in " << (mark - start) << " seconds" << std::endl;
+  std::cout << (positions_change ? "Index" : "Samples") << " written in " << (stop - mark) << " seconds" << std::endl;
+  std::cout << "SA samples: " << (rlcsa.getSASamples()->reportSize() / (double)MEGABYTE) << " MB" << std::endl;
+  std::cout << "Memory usage: " << memoryUsage() << " kB" << std::endl;
+  std::cout << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "rlcsa.h"
+#include "misc/utils.h"
+
+#ifdef MULTITHREAD_SUPPORT
+#include <omp.h>
+#endif
+
+
+using namespace CSA;
+
+
+/*
+  This program replaces the SA samples of an existing index with weighted samples
+  optimized for a query log. The log contains one pattern per line. Each pattern
+  is searched for, and each located text position gets weight 1 for each time it
+  is located. Every position also gets a base weight of 1, so that the positions
+  missing from the log are still sampled at some rate. WeightedSampler then places
+  the samples of each sequence separately, using the sample rate of the index to
+  determine the number of samples. The first position of each sequence is always
+  sampled.
+
+  Only the SA samples and the parameters are written. The index must support
+  locate for replaying the log.
+*/
+
+
+const int MAX_THREADS = 64;
+
+
+// Appends the sampled text positions of the sequence to the vector.
+void sampleSequence(const RLCSA& rlcsa, weight_type* weights, pair_type range, usint threads, std::vector<usint>& positions);
+
+
+int
+main(int argc, char** argv)
+{
+  std::cout << "Weighted sample builder" << std::endl;
+  if(argc < 3)
+  {
+    std::cout << "Usage: build_weighted_samples base_name query_log [threads]" << std::endl;
+    return 1;
+  }
+
+  std::string base_name = argv[1];
+  std::cout << "Base name: " << base_name << std::endl;
+  std::cout << "Query log: " << argv[2] << std::endl;
+  usint threads = 1;
+  if(argc > 3) { threads = std::min(MAX_THREADS, std::max(atoi(argv[3]), 1)); }
+  std::cout << "Threads: " << threads << std::endl;
+  std::cout << std::endl;
+
+  RLCSA rlcsa(base_name, false, false, threads);
+  if(!(rlcsa.isOk())) { return 2; }
+  if(!(rlcsa.supportsLocate()))
+  {
+    std::cerr << "The index must support locate!" << std::endl;
+    return 3;
+  }
+
+  std::ifstream log_file(argv[2], std::ios_base::binary);
+  if(!log_file)
+  {
+    std::cerr << "Error opening query log!" << std::endl;
+    return 4;
+  }
+  std::vector<std::string> queries;
+  readRows(log_file, queries, true);
+  log_file.close();
+
+  // Replay the queries.
+  double start = readTimer();
+  usint text_size = rlcsa.getTextSize(), occurrences = 0;
+  weight_type* weights = new weight_type[text_size];
+  std::fill(weights, weights + text_size, 1);
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #pragma omp parallel
+  #endif
+  {
+    QueryContext context(rlcsa);
+    #ifdef MULTITHREAD_SUPPORT
+    #pragma omp for schedule(dynamic, 1) reduction(+:occurrences)
+    #endif
+    for(sint i = 0; i < (sint)queries.size(); i++)
+    {
+      pair_type range = rlcsa.count(queries[i], context);
+      if(isEmpty(range)) { continue; }
+      usint* values = rlcsa.locate(range, context);
+      for(usint j = 0; j < length(range); j++)
+      {
+        #ifdef MULTITHREAD_SUPPORT
+        #pragma omp atomic
+        #endif
+        weights[values[j]]++;
+      }
+      occurrences += length(range);
+      delete[] values;
+    }
+  }
+  double replayed = readTimer();
+  std::cout << queries.size() << " queries with " << occurrences << " occurrences replayed in "
+            << (replayed - start) << " seconds" << std::endl;
+
+  // Sample the sequences. With fewer sequences than threads, the threads are used
+  // within the sampler instead.
+  usint sequences = rlcsa.getNumberOfSequences();
+  std::vector<usint> positions;
+  if(sequences < threads)
+  {
+    for(usint i = 0; i < sequences; i++)
+    {
+      sampleSequence(rlcsa, weights, rlcsa.getSequenceRange(i), threads, positions);
+    }
+  }
+  else
+  {
+    #ifdef MULTITHREAD_SUPPORT
+    omp_set_num_threads(threads);
+    #pragma omp parallel
+    #endif
+    {
+      std::vector<usint> thread_positions;
+      #ifdef MULTITHREAD_SUPPORT
+      #pragma omp for schedule(dynamic, 1)
+      #endif
+      for(sint i = 0; i < (sint)sequences; i++)
+      {
+        sampleSequence(rlcsa, weights, rlcsa.getSequenceRange(i), 1, thread_positions);
+      }
+      #ifdef MULTITHREAD_SUPPORT
+      #pragma omp critical
+      #endif
+      positions.insert(positions.end(), thread_positions.begin(), thread_positions.end());
+    }
+  }
+  delete[] weights; weights = 0;
+  double sampled = readTimer();
+  std::cout << positions.size() << " samples selected in " << (sampled - replayed) << " seconds" << std::endl;
+
+  // Replace the samples.
+  if(!(rlcsa.buildSASamples(positions, threads)))
+  {
+    std::cerr << "Error building the samples!" << std::endl;
+    return 5;
+  }
+  rlcsa.writeSamplesTo(base_name);
+  double stop = readTimer();
+
+  std::cout << rlcsa.getSASamples()->getNumberOfSamples() << " samples written in " << (stop - start) << " seconds" << std::endl;
+  std::cout << "Memory usage: " << memoryUsage() << " kB" << std::endl;
+  std::cout << std::endl;
+
+  return 0;
+}
+
+
+void
+sampleSequence(const RLCSA& rlcsa, weight_type* weights, pair_type range, usint threads, std::vector<usint>& positions)
+{
+  usint sequence_length = length(range), rate = std::max(rlcsa.getSampleRate(), (usint)1);
+
+  // WeightedSampler takes ownership of the weights.
+  weight_type* sequence_weights = new weight_type[sequence_length];
+  std::copy(weights + range.first, weights + range.second + 1, sequence_weights);
+  WeightedSampler sampler(sequence_weights, sequence_length, true);
+  if(sampler.buildSamples(rate, 0, threads))
+  {
+    for(usint i = 0; i < sampler.getItems(); i++)
+    {
+      usint pos = sampler.getSamplePosition(i);
+      if(pos < sequence_length) { positions.push_back(range.first + pos); }
+    }
+  }
+  else  // Fall back to regular sampling.
+  {
+    for(usint pos = 0; pos < sequence_length; pos += rate) { positions.push_back(range.first + pos); }
+  }
+}
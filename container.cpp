@@ -0,0 +1,419 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+
+#include "container.h"
+#include "rlcsa.h"
+
+
+namespace CSA
+{
+
+
+IndexContainer::IndexContainer(const std::string& _file_name) :
+  file_name(_file_name),
+  ok(false)
+{
+  std::ifstream file(this->file_name.c_str(), std::ios_base::binary);
+  if(!file) { return; }
+
+  usint header[HEADER_WORDS];
+  file.read((char*)header, sizeof(header));
+  if(!file || header[0] != MAGIC)
+  {
+    std::cerr << "IndexContainer: " << this->file_name << " is not an index container!" << std::endl;
+    return;
+  }
+  if(header[1] > VERSION)
+  {
+    std::cerr << "IndexContainer: Unsupported container version " << header[1] << "!" << std::endl;
+    return;
+  }
+
+  usint file_size = fileSize(file);
+  file.seekg(header[3]);
+  for(usint i = 0; i < header[2]; i++)
+  {
+    char name[NAME_BYTES];
+    usint values[3];
+    file.read(name, NAME_BYTES);
+    file.read((char*)values, sizeof(values));
+    if(!file || values[0] % ALIGNMENT != 0 || values[0] + values[1] > file_size)
+    {
+      std::cerr << "IndexContainer: Invalid section table in " << this->file_name << "!" << std::endl;
+      this->sections.clear();
+      return;
+    }
+    Section section;
+    section.name = std::string(name, strnlen(name, NAME_BYTES));
+    section.offset = values[0]; section.size = values[1]; section.checksum = values[2];
+    this->sections.push_back(section);
+  }
+
+  this->ok = true;
+}
+
+IndexContainer::~IndexContainer()
+{
+}
+
+//--------------------------------------------------------------------------
+
+const IndexContainer::Section*
+IndexContainer::findSection(const std::string& name) const
+{
+  for(usint i = 0; i < this->sections.size(); i++)
+  {
+    if(this->sections[i].name == name) { return &(this->sections[i]); }
+  }
+  return 0;
+}
+
+bool
+IndexContainer::openSection(const std::string& name, std::ifstream& file) const
+{
+  const Section* section = this->findSection(name);
+  if(section == 0) { return false; }
+
+  file.open(this->file_name.c_str(), std::ios_base::binary);
+  if(!file) { return false; }
+  file.seekg(section->offset);
+  return true;
+}
+
+FileMap*
+IndexContainer::mapSection(const std::string& name) const
+{
+  const Section* section = this->findSection(name);
+  if(section == 0) { return 0; }
+  return new FileMap(this->file_name, section->offset, section->size);
+}
+
+bool
+IndexContainer::verify(const std::string& name) const
+{
+  const Section* section = this->findSection(name);
+  if(section == 0) { return false; }
+
+  std::ifstream file(this->file_name.c_str(), std::ios_base::binary);
+  if(!file) { return false; }
+  file.seekg(section->offset);
+
+  const usint BUFFER_SIZE = MEGABYTE;
+  char* buffer = new char[BUFFER_SIZE];
+  usint hash = FNV_OFFSET;
+  for(usint pos = 0; pos < section->size; pos += BUFFER_SIZE)
+  {
+    usint bytes = std::min(BUFFER_SIZE, section->size - pos);
+    file.read(buffer, bytes);
+    if(!file) { break; }
+    hash = checksum(buffer, bytes, hash);
+  }
+  bool result = (file && hash == section->checksum);
+  delete[] buffer;
+
+  return result;
+}
+
+bool
+IndexContainer::verify() const
+{
+  for(usint i = 0; i < this->sections.size(); i++)
+  {
+    if(!(this->verify(this->sections[i].name))) { return false; }
+  }
+  return true;
+}
+
+usint
+IndexContainer::checksum(const char* data, usint bytes, usint hash)
+{
+  for(usint i = 0; i < bytes; i++)
+  {
+    hash = (hash ^ (uchar)(data[i])) * FNV_PRIME;
+  }
+  return hash;
+}
+
+//--------------------------------------------------------------------------
+
+const std::string ContainerWriter::TEMP_EXTENSION = ".tmp";
+
+ContainerWriter::ContainerWriter(const std::string& _file_name) :
+  file_name(_file_name), temp_name(_file_name + TEMP_EXTENSION),
+  ok(false), open_section(false), closed(false)
+{
+  this->file.open(this->temp_name.c_str(), std::ios_base::binary);
+  if(!(this->file))
+  {
+    std::cerr << "ContainerWriter: Error creating " << this->temp_name << "!" << std::endl;
+    return;
+  }
+
+  // The header is written again in close().
+  usint header[IndexContainer::HEADER_WORDS] = { 0, 0, 0, 0 };
+  this->file.write((char*)header, sizeof(header));
+  this->ok = true;
+}
+
+ContainerWriter::~ContainerWriter()
+{
+  if(!(this->closed))
+  {
+    if(this->file.is_open()) { this->file.close(); }
+    std::remove(this->temp_name.c_str());
+  }
+}
+
+std::ofstream&
+ContainerWriter::addSection(const std::string& name)
+{
+  this->endSection();
+  if(name.length() >= IndexContainer::NAME_BYTES)
+  {
+    std::cerr << "ContainerWriter: Section name " << name << " is too long!" << std::endl;
+    this->ok = false;
+  }
+
+  usint offset = this->file.tellp();
+  usint padding = (IndexContainer::ALIGNMENT - offset % IndexContainer::ALIGNMENT) % IndexContainer::ALIGNMENT;
+  for(usint i = 0; i < padding; i++) { this->file.put(0); }
+
+  IndexContainer::Section section;
+  section.name = name;
+  section.offset = offset + padding; section.size = 0; section.checksum = 0;
+  this->sections.push_back(section);
+  this->open_section = true;
+
+  return this->file;
+}
+
+bool
+ContainerWriter::addFile(const std::string& name, const std::string& source_name)
+{
+  std::ifstream source(source_name.c_str(), std::ios_base::binary);
+  if(!source)
+  {
+    std::cerr << "ContainerWriter: Error opening " << source_name << "!" << std::endl;
+    this->ok = false;
+    return false;
+  }
+
+  std::ofstream& output = this->addSection(name);
+  output << source.rdbuf();
+  return output.good();
+}
+
+bool
+ContainerWriter::copySection(const IndexContainer& source, const std::string& name)
+{
+  const IndexContainer::Section* section = source.findSection(name);
+  std::ifstream input;
+  if(section == 0 || !(source.openSection(name, input)))
+  {
+    std::cerr << "ContainerWriter: Error opening section " << name << " of " << source.getFileName() << "!" << std::endl;
+    this->ok = false;
+    return false;
+  }
+
+  std::ofstream& output = this->addSection(name);
+  const usint BUFFER_SIZE = MEGABYTE;
+  char* buffer = new char[BUFFER_SIZE];
+  for(usint pos = 0; pos < section->size; pos += BUFFER_SIZE)
+  {
+    usint bytes = std::min(BUFFER_SIZE, section->size - pos);
+    input.read(buffer, bytes);
+    output.write(buffer, bytes);
+  }
+  delete[] buffer;
+  return (input.good() && output.good());
+}
+
+void
+ContainerWriter::endSection()
+{
+  if(!(this->open_section)) { return; }
+  IndexContainer::Section& section = this->sections.back();
+  section.size = (usint)(this->file.tellp()) - section.offset;
+  this->open_section = false;
+}
+
+bool
+ContainerWriter::close()
+{
+  if(this->closed) { return this->ok; }
+  this->endSection();
+
+  // Write the section table.
+  usint table_offset = this->file.tellp();
+  for(usint i = 0; i < this->sections.size(); i++)
+  {
+    char name[IndexContainer::NAME_BYTES];
+    memset(name, 0, IndexContainer::NAME_BYTES);
+    strncpy(name, this->sections[i].name.c_str(), IndexContainer::NAME_BYTES - 1);
+    this->file.write(name, IndexContainer::NAME_BYTES);
+    usint values[3] = { this->sections[i].offset, this->sections[i].size, 0 };
+    this->file.write((char*)values, sizeof(values));
+  }
+  usint header[IndexContainer::HEADER_WORDS] =
+  {
+    IndexContainer::MAGIC, IndexContainer::VERSION, (usint)(this->sections.size()), table_offset
+  };
+  this->file.seekp(0);
+  this->file.write((char*)header, sizeof(header));
+  this->file.close();
+  if(!(this->file)) { this->ok = false; }
+  if(!(this->ok))
+  {
+    std::cerr << "ContainerWriter: Error writing " << this->temp_name << "!" << std::endl;
+    return false;
+  }
+
+  // Compute the checksums from the written file.
+  std::fstream output(this->temp_name.c_str(), std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+  IndexContainer container(this->temp_name);
+  if(!output || !(container.isOk()))
+  {
+    this->ok = false;
+    return false;
+  }
+  const usint BUFFER_SIZE = MEGABYTE;
+  char* buffer = new char[BUFFER_SIZE];
+  for(usint i = 0; i < this->sections.size(); i++)
+  {
+    usint hash = IndexContainer::FNV_OFFSET;
+    output.seekg(this->sections[i].offset);
+    for(usint pos = 0; pos < this->sections[i].size; pos += BUFFER_SIZE)
+    {
+      usint bytes = std::min(BUFFER_SIZE, this->sections[i].size - pos);
+      output.read(buffer, bytes);
+      hash = IndexContainer::checksum(buffer, bytes, hash);
+    }
+    output.seekp(table_offset + i * (IndexContainer::NAME_BYTES + 3 * sizeof(usint)) + IndexContainer::NAME_BYTES + 2 * sizeof(usint));
+    output.write((char*)&hash, sizeof(hash));
+  }
+  delete[] buffer;
+  output.close();
+  if(!output) { this->ok = false; return false; }
+
+  if(std::rename(this->temp_name.c_str(), this->file_name.c_str()) != 0)
+  {
+    std::cerr << "ContainerWriter: Cannot replace " << this->file_name << "!" << std::endl;
+    this->ok = false;
+    return false;
+  }
+
+  this->closed = true;
+  return true;
+}
+
+//--------------------------------------------------------------------------
+
+bool
+isContainer(const std::string& base_name)
+{
+  std::ifstream file((base_name + CONTAINER_EXTENSION).c_str(), std::ios_base::binary);
+  return file.good();
+}
+
+bool
+isNewerThanContainer(const std::string& base_name, const std::string& extension)
+{
+  struct stat container_info, file_info;
+  if(stat((base_name + CONTAINER_EXTENSION).c_str(), &container_info) != 0) { return false; }
+  if(stat((base_name + extension).c_str(), &file_info) != 0) { return false; }
+
+  const timespec& container_time = container_info.st_mtim;
+  const timespec& file_time = file_info.st_mtim;
+  return (file_time.tv_sec > container_time.tv_sec ||
+    (file_time.tv_sec == container_time.tv_sec && file_time.tv_nsec > container_time.tv_nsec));
+}
+
+// The separate file is used if it has been written after the container.
+bool
+useContainer(const std::string& base_name, const std::string& extension)
+{
+  if(!isContainer(base_name)) { return false; }
+  if(!isNewerThanContainer(base_name, extension)) { return true; }
+
+  // Each file is reported once, as the parallel loader opens the same file many times.
+  static std::set<std::string> reported;
+  #pragma omp critical(container_warning)
+  {
+    if(reported.insert(base_name + extension).second)
+    {
+      std::cerr << "Warning: " << base_name << extension << " is newer than the container and is used instead!" << std::endl;
+    }
+  }
+  return false;
+}
+
+bool
+openIndexFile(const std::string& base_name, const std::string& extension, std::ifstream& file)
+{
+  usint size = 0;
+  return openIndexFile(base_name, extension, file, size);
+}
+
+bool
+openIndexFile(const std::string& base_name, const std::string& extension, std::ifstream& file, usint& size)
+{
+  if(useContainer(base_name, extension))
+  {
+    IndexContainer container(base_name + CONTAINER_EXTENSION);
+    const IndexContainer::Section* section = (container.isOk() ? container.findSection(extension) : 0);
+    if(section == 0 || !(container.openSection(extension, file))) { return false; }
+    size = section->size;
+    return true;
+  }
+
+  file.open((base_name + extension).c_str(), std::ios_base::binary);
+  if(!file) { return false; }
+  size = fileSize(file);
+  return true;
+}
+
+FileMap*
+mapIndexFile(const std::string& base_name, const std::string& extension)
+{
+  if(useContainer(base_name, extension))
+  {
+    IndexContainer container(base_name + CONTAINER_EXTENSION);
+    return (container.isOk() ? container.mapSection(extension) : 0);
+  }
+
+  std::ifstream file((base_name + extension).c_str(), std::ios_base::binary);
+  if(!file) { return 0; }
+  file.close();
+  return new FileMap(base_name + extension);
+}
+
+bool
+readIndexParameters(const std::string& base_name, Parameters& parameters)
+{
+  if(useContainer(base_name, PARAMETERS_EXTENSION))
+  {
+    IndexContainer container(base_name + CONTAINER_EXTENSION);
+    const IndexContainer::Section* section = container.findSection(PARAMETERS_EXTENSION);
+    std::ifstream file;
+    if(section == 0 || !(container.openSection(PARAMETERS_EXTENSION, file))) { return false; }
+
+    // The parameters are read until the end of the stream.
+    std::string contents(section->size, '\0');
+    file.read(&(contents[0]), section->size);
+    std::istringstream stream(contents);
+    parameters.read(stream);
+    return true;
+  }
+
+  std::ifstream file((base_name + PARAMETERS_EXTENSION).c_str(), std::ios_base::binary);
+  if(!file) { return false; }
+  parameters.read(file);
+  return true;
+}
+
+
+} // namespace CSA
@@ -0,0 +1,161 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "misc/parameters.h"
+#include "bits/bitbuffer.h"
+
+
+namespace CSA
+{
+
+
+/*
+  An index container stores the files of an index as sections of a single file
+  base_name + CONTAINER_EXTENSION. Each section is named by the extension of the
+  file it replaces, and its contents are identical to the file.
+
+  The container starts with a header (magic, version, number of sections, offset of
+  the section table). Each section starts at a multiple of ALIGNMENT bytes, so it can
+  be memory mapped separately. The section table follows the last section. For each
+  section, it stores the name, the offset and the size in bytes, and an FNV-1a
+  checksum of the contents.
+
+  A new container is written to a temporary file, which is renamed when the container
+  is complete. Readers never see a partially written container.
+*/
+
+class IndexContainer
+{
+  public:
+    const static usint MAGIC = (usint)0x524E544E4F43534CULL;  // "LSCONTNR"
+    const static usint VERSION = 1;
+    const static usint ALIGNMENT = 4096;
+    const static usint NAME_BYTES = 32;
+    const static usint HEADER_WORDS = 4;
+
+    struct Section
+    {
+      std::string name;
+      usint       offset, size, checksum;
+    };
+
+    // Reads the header and the section table of the container file.
+    explicit IndexContainer(const std::string& file_name);
+    ~IndexContainer();
+
+    inline bool isOk() const { return this->ok; }
+    inline const std::string& getFileName() const { return this->file_name; }
+
+    inline usint getNumberOfSections() const { return this->sections.size(); }
+    inline const Section& getSection(usint i) const { return this->sections[i]; }
+
+    // Returns the section with the given name, or 0 if there is no such section.
+    const Section* findSection(const std::string& name) const;
+
+    // Opens the file and positions it at the start of the section.
+    bool openSection(const std::string& name, std::ifstream& file) const;
+
+    // Maps the section into memory. The caller must delete the mapping.
+    FileMap* mapSection(const std::string& name) const;
+
+    // Compares the checksums with the contents. Verifying reads the entire section.
+    bool verify(const std::string& name) const;
+    bool verify() const;
+
+    static usint checksum(const char* data, usint bytes, usint hash = FNV_OFFSET);
+
+    const static usint FNV_OFFSET = (usint)0xCBF29CE484222325ULL;
+    const static usint FNV_PRIME  = (usint)0x100000001B3ULL;
+
+  private:
+    std::string          file_name;
+    std::vector<Section> sections;
+    bool                 ok;
+
+    // These are not allowed.
+    IndexContainer();
+    IndexContainer(const IndexContainer&);
+    IndexContainer& operator = (const IndexContainer&);
+};
+
+
+//--------------------------------------------------------------------------
+
+
+class ContainerWriter
+{
+  public:
+    // The container is written to file_name + TEMP_EXTENSION until close().
+    explicit ContainerWriter(const std::string& file_name);
+
+    // Removes the temporary file, if the container was not closed.
+    ~ContainerWriter();
+
+    inline bool isOk() const { return this->ok; }
+
+    // Starts a new section and returns the stream for writing its contents.
+    // The previous section ends when the next one starts.
+    std::ofstream& addSection(const std::string& name);
+
+    // Copies the file as a new section.
+    bool addFile(const std::string& name, const std::string& source_name);
+
+    // Copies the section of another container as a new section.
+    bool copySection(const IndexContainer& source, const std::string& name);
+
+    // Writes the section table and replaces file_name with the new container.
+    bool close();
+
+    const static std::string TEMP_EXTENSION;
+
+  private:
+    std::string    file_name, temp_name;
+    std::ofstream  file;
+    std::vector<IndexContainer::Section> sections;
+    bool           ok, open_section, closed;
+
+    void endSection();
+
+    // These are not allowed.
+    ContainerWriter();
+    ContainerWriter(const ContainerWriter&);
+    ContainerWriter& operator = (const ContainerWriter&);
+};
+
+
+//--------------------------------------------------------------------------
+
+/*
+  These functions load the file base_name + extension of an index. If the index is
+  stored in a container, the corresponding section is used instead. A separate file
+  written after the container replaces the section with a warning, until the index
+  is packed again.
+*/
+
+bool isContainer(const std::string& base_name);
+
+// Returns true if the file exists and has been written after the container.
+bool isNewerThanContainer(const std::string& base_name, const std::string& extension);
+
+// Opens the file and positions it at the start of the data.
+bool openIndexFile(const std::string& base_name, const std::string& extension, std::ifstream& file);
+
+// As above, but also returns the size of the data in bytes. A section of a container is
+// followed by other data, so the end of the stream is not the end of the section.
+bool openIndexFile(const std::string& base_name, const std::string& extension, std::ifstream& file, usint& size);
+
+// Maps the file into memory. Returns 0 if the file does not exist.
+FileMap* mapIndexFile(const std::string& base_name, const std::string& extension);
+
+// Returns false if the parameter file does not exist.
+bool readIndexParameters(const std::string& base_name, Parameters& parameters);
+
+
+} // namespace CSA
+
+
+#endif // CONTAINER_H
@@ -1,140 +1,314 @@
 adaptive_samples.o: adaptive_samples.cpp adaptive_samples.h rlcsa.h \
   bits/deltavector.h bits/bitvector.h bits/../misc/definitions.h \
-  bits/bitbuffer.h bits/rlevector.h bits/nibblevector.h \
-  bits/succinctvector.h sasamples.h sampler.h misc/utils.h \
-  misc/definitions.h bits/bitbuffer.h alphabet.h misc/definitions.h \
-  lcpsamples.h bits/array.h misc/parameters.h suffixarray.h
+  bits/bitbuffer.h bits/rlevector.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h bits/succinctvector.h \
+  sasamples.h sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h \
+  bits/savector.h bits/deltavector.h bits/succinctvector.h alphabet.h \
+  misc/definitions.h kmertable.h runsamples.h lcpsamples.h bits/array.h \
+  misc/parameters.h suffixarray.h container.h
 alphabet.o: alphabet.cpp alphabet.h misc/definitions.h
+build_kmer_table.o: build_kmer_table.cpp rlcsa.h bits/deltavector.h \
+  bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
+  suffixarray.h
 build_plcp.o: build_plcp.cpp rlcsa.h bits/deltavector.h bits/bitvector.h \
   bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
-  bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
-  misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
 build_rlcsa.o: build_rlcsa.cpp rlcsa_builder.h rlcsa.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
-  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
-  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
+  suffixarray.h
+build_run_samples.o: build_run_samples.cpp rlcsa.h bits/deltavector.h \
+  bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
 build_sa.o: build_sa.cpp suffixarray.h misc/definitions.h misc/utils.h \
   misc/definitions.h
-display_test.o: display_test.cpp rlcsa.h bits/deltavector.h \
+build_sa_samples.o: build_sa_samples.cpp rlcsa.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
-  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
-  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
-docarray.o: docarray.cpp docarray.h rlcsa.h bits/deltavector.h \
+build_weighted_samples.o: build_weighted_samples.cpp rlcsa.h \
+  bits/deltavector.h bits/bitvector.h bits/../misc/definitions.h \
+  bits/bitbuffer.h bits/rlevector.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h bits/succinctvector.h \
+  sasamples.h sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h \
+  bits/savector.h bits/deltavector.h bits/succinctvector.h alphabet.h \
+  misc/definitions.h kmertable.h runsamples.h lcpsamples.h bits/array.h \
+  misc/parameters.h suffixarray.h
+container.o: container.cpp container.h misc/parameters.h \
+  misc/definitions.h bits/bitbuffer.h bits/../misc/definitions.h rlcsa.h \
+  bits/deltavector.h bits/bitvector.h bits/bitbuffer.h bits/rlevector.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h bits/savector.h bits/deltavector.h bits/succinctvector.h \
+  alphabet.h misc/definitions.h kmertable.h runsamples.h lcpsamples.h \
+  bits/array.h suffixarray.h
+display_test.o: display_test.cpp rlcsa.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
-  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
-  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
+docarray.o: docarray.cpp container.h misc/parameters.h misc/definitions.h \
+  bits/bitbuffer.h bits/../misc/definitions.h docarray.h rlcsa.h \
+  bits/deltavector.h bits/bitvector.h bits/bitbuffer.h bits/rlevector.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h bits/savector.h bits/deltavector.h bits/succinctvector.h \
+  alphabet.h misc/definitions.h kmertable.h runsamples.h lcpsamples.h \
+  bits/array.h suffixarray.h
 document_graph.o: document_graph.cpp rlcsa.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
-  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
-  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h docarray.h
 extract_sequence.o: extract_sequence.cpp rlcsa.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
-  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
-  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
-lcp_test.o: lcp_test.cpp rlcsa.h bits/deltavector.h bits/bitvector.h \
+fmd.o: fmd.cpp fmd.h bits/deltavector.h bits/bitvector.h \
   bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
   bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
-  misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
-  suffixarray.h
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  lcpsamples.h bits/array.h misc/parameters.h suffixarray.h rlcsa.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h kmertable.h runsamples.h
+fmd_grep.o: fmd_grep.cpp fmd.h bits/deltavector.h bits/bitvector.h \
+  bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
+  bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  lcpsamples.h bits/array.h misc/parameters.h suffixarray.h rlcsa.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h kmertable.h runsamples.h
+kmertable.o: kmertable.cpp container.h misc/parameters.h \
+  misc/definitions.h bits/bitbuffer.h bits/../misc/definitions.h \
+  kmertable.h misc/definitions.h rlcsa.h bits/deltavector.h \
+  bits/bitvector.h bits/bitbuffer.h bits/rlevector.h bits/psivector.h \
+  bits/rlevector.h bits/nibblevector.h bits/eliasfanovector.h \
+  bits/succinctvector.h sasamples.h sampler.h misc/utils.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h runsamples.h \
+  lcpsamples.h bits/array.h suffixarray.h
+lcp_test.o: lcp_test.cpp container.h misc/parameters.h misc/definitions.h \
+  bits/bitbuffer.h bits/../misc/definitions.h rlcsa.h bits/deltavector.h \
+  bits/bitvector.h bits/bitbuffer.h bits/rlevector.h bits/psivector.h \
+  bits/rlevector.h bits/nibblevector.h bits/eliasfanovector.h \
+  bits/succinctvector.h sasamples.h sampler.h misc/utils.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h suffixarray.h
 lcpsamples.o: lcpsamples.cpp lcpsamples.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
   bits/array.h misc/utils.h misc/definitions.h
 locate_test.o: locate_test.cpp rlcsa.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
-  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
-  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
+  suffixarray.h
+main.o: main.cpp kseq.h rlcsa.h bits/deltavector.h bits/bitvector.h \
+  bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
+  suffixarray.h rlcsa_builder.h
+merge_rlcsa.o: merge_rlcsa.cpp rlcsa_builder.h rlcsa.h bits/deltavector.h \
+  bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
+pack_index.o: pack_index.cpp container.h misc/parameters.h \
+  misc/definitions.h bits/bitbuffer.h bits/../misc/definitions.h rlcsa.h \
+  bits/deltavector.h bits/bitvector.h bits/bitbuffer.h bits/rlevector.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h bits/savector.h bits/deltavector.h bits/succinctvector.h \
+  alphabet.h misc/definitions.h kmertable.h runsamples.h lcpsamples.h \
+  bits/array.h suffixarray.h
 parallel_build.o: parallel_build.cpp rlcsa_builder.h rlcsa.h \
   bits/deltavector.h bits/bitvector.h bits/../misc/definitions.h \
-  bits/bitbuffer.h bits/rlevector.h bits/nibblevector.h \
-  bits/succinctvector.h sasamples.h sampler.h misc/utils.h \
-  misc/definitions.h bits/bitbuffer.h alphabet.h misc/definitions.h \
-  lcpsamples.h bits/array.h misc/parameters.h suffixarray.h
+  bits/bitbuffer.h bits/rlevector.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h bits/succinctvector.h \
+  sasamples.h sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h \
+  bits/savector.h bits/deltavector.h bits/succinctvector.h alphabet.h \
+  misc/definitions.h kmertable.h runsamples.h lcpsamples.h bits/array.h \
+  misc/parameters.h suffixarray.h
+queryserver.o: queryserver.cpp container.h misc/parameters.h \
+  misc/definitions.h bits/bitbuffer.h bits/../misc/definitions.h \
+  queryserver.h fmd.h bits/deltavector.h bits/bitvector.h bits/bitbuffer.h \
+  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
+  sampler.h misc/utils.h bits/savector.h bits/deltavector.h \
+  bits/succinctvector.h alphabet.h misc/definitions.h lcpsamples.h \
+  bits/array.h suffixarray.h rlcsa.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h kmertable.h runsamples.h
 read_bwt.o: read_bwt.cpp rlcsa.h bits/deltavector.h bits/bitvector.h \
   bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
-  bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
-  misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
-rlcsa.o: rlcsa.cpp rlcsa.h bits/deltavector.h bits/bitvector.h \
-  bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
-  bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
-  misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
-  suffixarray.h bits/vectors.h
+rlcsa.o: rlcsa.cpp container.h misc/parameters.h misc/definitions.h \
+  bits/bitbuffer.h bits/../misc/definitions.h rlcsa.h bits/deltavector.h \
+  bits/bitvector.h bits/bitbuffer.h bits/rlevector.h bits/psivector.h \
+  bits/rlevector.h bits/nibblevector.h bits/eliasfanovector.h \
+  bits/succinctvector.h sasamples.h sampler.h misc/utils.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h suffixarray.h \
+  bits/vectors.h
 rlcsa_builder.o: rlcsa_builder.cpp rlcsa_builder.h rlcsa.h \
   bits/deltavector.h bits/bitvector.h bits/../misc/definitions.h \
-  bits/bitbuffer.h bits/rlevector.h bits/nibblevector.h \
-  bits/succinctvector.h sasamples.h sampler.h misc/utils.h \
-  misc/definitions.h bits/bitbuffer.h alphabet.h misc/definitions.h \
-  lcpsamples.h bits/array.h misc/parameters.h suffixarray.h
-rlcsa_grep.o: rlcsa_grep.cpp rlcsa.h bits/deltavector.h bits/bitvector.h \
-  bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
-  bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
-  misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
+  bits/bitbuffer.h bits/rlevector.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h bits/succinctvector.h \
+  sasamples.h sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h \
+  bits/savector.h bits/deltavector.h bits/succinctvector.h alphabet.h \
+  misc/definitions.h kmertable.h runsamples.h lcpsamples.h bits/array.h \
+  misc/parameters.h suffixarray.h
+rlcsa_client.o: rlcsa_client.cpp queryserver.h fmd.h bits/deltavector.h \
+  bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
+  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
+  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h \
+  bits/savector.h bits/deltavector.h bits/succinctvector.h alphabet.h \
   misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
-  suffixarray.h
+  suffixarray.h rlcsa.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h kmertable.h runsamples.h
+rlcsa_grep.o: rlcsa_grep.cpp container.h misc/parameters.h \
+  misc/definitions.h bits/bitbuffer.h bits/../misc/definitions.h \
+  docarray.h rlcsa.h bits/deltavector.h bits/bitvector.h bits/bitbuffer.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h bits/savector.h bits/deltavector.h bits/succinctvector.h \
+  alphabet.h misc/definitions.h kmertable.h runsamples.h lcpsamples.h \
+  bits/array.h suffixarray.h
+rlcsa_server.o: rlcsa_server.cpp queryserver.h fmd.h bits/deltavector.h \
+  bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
+  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
+  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h \
+  bits/savector.h bits/deltavector.h bits/succinctvector.h alphabet.h \
+  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  suffixarray.h rlcsa.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h kmertable.h runsamples.h
 rlcsa_test.o: rlcsa_test.cpp rlcsa.h bits/deltavector.h bits/bitvector.h \
   bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
-  bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
-  misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
-  suffixarray.h adaptive_samples.h docarray.h
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
+  suffixarray.h adaptive_samples.h samplecache.h docarray.h
+runsamples.o: runsamples.cpp runsamples.h bits/bitbuffer.h \
+  bits/../misc/definitions.h bits/deltavector.h bits/bitvector.h \
+  bits/bitbuffer.h rlcsa.h bits/rlevector.h bits/psivector.h \
+  bits/rlevector.h bits/nibblevector.h bits/eliasfanovector.h \
+  bits/succinctvector.h sasamples.h sampler.h misc/utils.h \
+  misc/definitions.h bits/savector.h bits/deltavector.h \
+  bits/succinctvector.h alphabet.h misc/definitions.h kmertable.h \
+  lcpsamples.h bits/array.h misc/parameters.h suffixarray.h
 sample_lcp.o: sample_lcp.cpp rlcsa.h bits/deltavector.h bits/bitvector.h \
   bits/../misc/definitions.h bits/bitbuffer.h bits/rlevector.h \
-  bits/nibblevector.h bits/succinctvector.h sasamples.h sampler.h \
-  misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
+samplecache.o: samplecache.cpp container.h misc/parameters.h \
+  misc/definitions.h bits/bitbuffer.h bits/../misc/definitions.h \
+  samplecache.h rlcsa.h bits/deltavector.h bits/bitvector.h \
+  bits/bitbuffer.h bits/rlevector.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h bits/succinctvector.h \
+  sasamples.h sampler.h misc/utils.h bits/savector.h bits/deltavector.h \
+  bits/succinctvector.h alphabet.h misc/definitions.h kmertable.h \
+  runsamples.h lcpsamples.h bits/array.h suffixarray.h
 sampler.o: sampler.cpp sampler.h misc/utils.h misc/definitions.h rlcsa.h \
   bits/deltavector.h bits/bitvector.h bits/../misc/definitions.h \
-  bits/bitbuffer.h bits/rlevector.h bits/nibblevector.h \
-  bits/succinctvector.h sasamples.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
-  suffixarray.h
+  bits/bitbuffer.h bits/rlevector.h bits/psivector.h bits/rlevector.h \
+  bits/nibblevector.h bits/eliasfanovector.h bits/succinctvector.h \
+  sasamples.h bits/bitbuffer.h bits/savector.h bits/deltavector.h \
+  bits/succinctvector.h alphabet.h misc/definitions.h kmertable.h \
+  runsamples.h lcpsamples.h bits/array.h misc/parameters.h suffixarray.h
 sampler_test.o: sampler_test.cpp rlcsa.h bits/deltavector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
-  bits/rlevector.h bits/nibblevector.h bits/succinctvector.h sasamples.h \
-  sampler.h misc/utils.h misc/definitions.h bits/bitbuffer.h alphabet.h \
-  misc/definitions.h lcpsamples.h bits/array.h misc/parameters.h \
+  bits/rlevector.h bits/psivector.h bits/rlevector.h bits/nibblevector.h \
+  bits/eliasfanovector.h bits/succinctvector.h sasamples.h sampler.h \
+  misc/utils.h misc/definitions.h bits/bitbuffer.h bits/savector.h \
+  bits/deltavector.h bits/succinctvector.h alphabet.h misc/definitions.h \
+  kmertable.h runsamples.h lcpsamples.h bits/array.h misc/parameters.h \
   suffixarray.h
 sasamples.o: sasamples.cpp sasamples.h sampler.h misc/utils.h \
   misc/definitions.h bits/bitbuffer.h bits/../misc/definitions.h \
-  bits/deltavector.h bits/bitvector.h bits/bitbuffer.h
+  bits/savector.h bits/deltavector.h bits/bitvector.h bits/bitbuffer.h \
+  bits/succinctvector.h
 ss_test.o: ss_test.cpp misc/utils.h misc/definitions.h
 suffixarray.o: suffixarray.cpp misc/utils.h misc/definitions.h \
   suffixarray.h misc/definitions.h
 array.o: bits/array.cpp bits/array.h bits/../misc/definitions.h \
   bits/bitbuffer.h
 bitbuffer.o: bits/bitbuffer.cpp bits/bitbuffer.h \
+  bits/../misc/definitions.h bits/../misc/utils.h \
   bits/../misc/definitions.h
 bitvector.o: bits/bitvector.cpp bits/bitvector.h \
-  bits/../misc/definitions.h bits/bitbuffer.h
+  bits/../misc/definitions.h bits/bitbuffer.h bits/../misc/utils.h \
+  bits/../misc/definitions.h
 deltavector.o: bits/deltavector.cpp bits/deltavector.h bits/bitvector.h \
   bits/../misc/definitions.h bits/bitbuffer.h
+eliasfanovector.o: bits/eliasfanovector.cpp bits/eliasfanovector.h \
+  bits/rlevector.h bits/bitvector.h bits/../misc/definitions.h \
+  bits/bitbuffer.h bits/../misc/utils.h bits/../misc/definitions.h
 multiarray.o: bits/multiarray.cpp bits/multiarray.h bits/array.h \
   bits/../misc/definitions.h bits/bitbuffer.h bits/succinctvector.h \
   bits/bitvector.h
 nibblevector.o: bits/nibblevector.cpp bits/nibblevector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
   bits/../misc/utils.h bits/../misc/definitions.h
+psivector.o: bits/psivector.cpp bits/psivector.h bits/rlevector.h \
+  bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
+  bits/nibblevector.h bits/eliasfanovector.h
 rlevector.o: bits/rlevector.cpp bits/rlevector.h bits/bitvector.h \
   bits/../misc/definitions.h bits/bitbuffer.h bits/../misc/utils.h \
   bits/../misc/definitions.h
+savector.o: bits/savector.cpp bits/savector.h bits/deltavector.h \
+  bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
+  bits/succinctvector.h
 succinctvector.o: bits/succinctvector.cpp bits/succinctvector.h \
   bits/bitvector.h bits/../misc/definitions.h bits/bitbuffer.h \
   bits/../misc/utils.h bits/../misc/definitions.h
@@ -6,6 +6,7 @@
 #include <sstream>
 #include <vector>
 
+#include "container.h"
 #include "docarray.h"
 #include "misc/utils.h"
 
@@ -311,14 +312,15 @@ DocArray::DocArray(const RLCSA& _rlcsa, const std::string& base_name, bool load_
   block_borders(0), blocks(0),
   ok(false), has_grammar(false), uses_rle(false)
 {
-  std::string input_name = base_name + DOCUMENT_EXTENSION;
-  std::ifstream input(input_name.c_str(), std::ios_base::binary);
-  if(!input)
+  std::ifstream input;
+  usint size = 0;
+  if(!openIndexFile(base_name, DOCUMENT_EXTENSION, input, size))
   {
-    std::cerr << "DocArray: Error opening input file " << input_name << "!" << std::endl;
+    std::cerr << "DocArray: Error opening input file " << (base_name + DOCUMENT_EXTENSION) << "!" << std::endl;
     return;
   }
 
+  std::streampos start = input.tellg();
   usint flags = 0;
   input.read((char*)(&flags), sizeof(flags));
   if(flags & RLE_FLAG) { this->uses_rle = true; }
@@ -332,7 +334,8 @@ DocArray::DocArray(const RLCSA& _rlcsa, const std::string& base_name, bool load_
     length(this->getNumberOfLeaves()));
   this->ok = true;
 
-  if(load_grammar)
+  // The file has no grammar before readRules() has been used.
+  if(load_grammar && input && (usint)(input.tellg() - start) < size)
   {
     this->rule_borders = new SuccinctVector(input);
     this->rules = new ReadBuffer(input, this->rule_borders->getSize(),
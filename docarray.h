@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "rlcsa.h"
+#include "misc/utils.h"
 
 
 namespace CSA
@@ -197,8 +198,8 @@ class DocArray
     {
       if(isEmpty(range)) { return; }
 
-      usint* res = this->rlcsa.locate(range);
-      this->rlcsa.getSequenceForPosition(res, length(range));
+      usint* res = this->rlcsa.parallelLocate(range, maxThreads());
+      this->rlcsa.getSequenceForPosition(res, length(range), maxThreads());
       for(usint i = 0; i < length(range); i++)
       {
         this->addItem(res[i], result);
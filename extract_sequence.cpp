@@ -16,12 +16,16 @@ const int MAX_THREADS = 64;
 using namespace CSA;
 
 
+// The sequence is displayed and written in blocks of this size.
+const usint BLOCK_SIZE = 16 * MEGABYTE;
+
+
 int main(int argc, char** argv)
 {
   std::cout << "RLCSA display test" << std::endl;
   if(argc < 4)
   {
-    std::cout << "Usage: extract_sequence base_name sequence_number output" << std::endl;
+    std::cout << "Usage: extract_sequence base_name sequence_number output [threads]" << std::endl;
     return 1;
   }
 
@@ -29,9 +33,14 @@ int main(int argc, char** argv)
   usint sequence = atoi(argv[2]);
   std::cout << "Sequence number: " << sequence << std::endl;
   std::cout << "Output: " << argv[3] << std::endl;
+  usint threads = 1;
+  #ifdef MULTITHREAD_SUPPORT
+  if(argc > 4) { threads = std::min(MAX_THREADS, std::max(atoi(argv[4]), 1)); }
+  std::cout << "Threads: " << threads << std::endl;
+  #endif
   std::cout << std::endl;
 
-  RLCSA rlcsa(argv[1]);
+  RLCSA rlcsa(argv[1], false, false, threads);
   if(!rlcsa.supportsDisplay())
   {
     std::cerr << "Error: Display is not supported!" << std::endl;
@@ -53,9 +62,14 @@ int main(int argc, char** argv)
   }
 
   double start = readTimer();
-  uchar* buffer = rlcsa.display(sequence);
   usint bytes = length(rlcsa.getSequenceRange(sequence));
-  output.write((char*)buffer, bytes);
+  uchar* buffer = new uchar[std::min(bytes, BLOCK_SIZE)];
+  for(usint offset = 0; offset < bytes; offset += BLOCK_SIZE)
+  {
+    pair_type block(offset, std::min(offset + BLOCK_SIZE, bytes) - 1);
+    rlcsa.parallelDisplay(sequence, block, buffer, threads);
+    output.write((char*)buffer, length(block));
+  }
   delete[] buffer;
   output.close();
 
@@ -437,13 +437,20 @@ std::pair<FMDPosition, usint> FMDIterator::pop()
   return toReturn;
 }
 
-FMD::FMD(const std::string& base_name, bool print): 
-  RLCSA(base_name, print)
+FMD::FMD(const std::string& base_name, bool print, bool memory_map, usint threads) :
+  RLCSA(base_name, print, memory_map, threads)
 {
 }
 
 FMDPosition
 FMD::extend(FMDPosition range, usint c, bool backward) const
+{
+  QueryContext context(*this);
+  return this->extend(range, c, backward, context);
+}
+
+FMDPosition
+FMD::extend(FMDPosition range, usint c, bool backward, QueryContext& context) const
 {
 
   // More or less directly implemented off of algorithms 2 and 3 in "Exploring
@@ -490,11 +497,11 @@ FMD::extend(FMDPosition range, usint c, bool backward) const
         
       DEBUG(std::cout << "\t\tstart = " << start << std::endl;)
       
-      // Get a pointer to the bit vector for this letter, which might be NULL if
-      // this base never appeared.
-      PsiVector* vector = this->array[(usint)BASES[base]];
+      // Get the iterator for the bit vector for this letter, which might be NULL
+      // if this base never appeared.
+      PsiVector::Iterator* iter = context[(usint)BASES[base]];
       
-      if(vector == NULL)
+      if(iter == NULL)
       {
         DEBUG(std::cout << "\t\tCharacter never appeared!" << std::endl;)
         
@@ -507,22 +514,16 @@ FMD::extend(FMDPosition range, usint c, bool backward) const
       else
       {
         DEBUG(std::cout << "\t\tCharacter appeared." << std::endl;)
-        
-        // Get an iterator for the bit vector for this character, for
-        // calculating ranks/occurrences.
-        PsiVector::Iterator iter(*vector);
-        
-        DEBUG(std::cout << "\t\tGot iterator" << std::endl;)
       
         // Fill in the forward-strand start positions and range end_offsets for
         // each base's answer. TODO: do we want at_least set or not? What does
         // it do?
         
         // First cache the forward_start rank we re-use
-        usint forward_start_rank = iter.rank(range.forward_start, true);
+        usint forward_start_rank = iter->rank(range.forward_start, true);
         
         answers[base].forward_start = start + forward_start_rank;
-        answers[base].end_offset = iter.rank(range.forward_start + 
+        answers[base].end_offset = iter->rank(range.forward_start + 
           range.end_offset, false) - forward_start_rank;
           
       }
@@ -599,7 +600,7 @@ FMD::extend(FMDPosition range, usint c, bool backward) const
   {
     // Flip the interval, do backwards search with the reverse complement of the
     // base, and then flip back.
-    return this->extend(range.flip(), reverse_complement(c), true).flip();
+    return this->extend(range.flip(), reverse_complement(c), true, context).flip();
   
   }
 }
@@ -667,13 +668,24 @@ FMD::fmdCount(const std::string& pattern, bool backward) const
 
   // Keep an FMDPosition to store our intermediate result in.
   FMDPosition index_position;
+  QueryContext context(*this);
 
   if(backward)
   {
     // Start at the end of the pattern and work towards the front
     
     std::string::const_reverse_iterator iter = pattern.rbegin();
-    index_position = this->getCharPosition((uchar)*iter);
+    if(pattern.length() >= this->getKmerLength() &&
+      this->getKmerPosition(pattern, pattern.length() - this->getKmerLength(),
+      index_position))
+    {
+      // Start from the range of the last k characters.
+      iter += this->getKmerLength() - 1;
+    }
+    else
+    {
+      index_position = this->getCharPosition((uchar)*iter);
+    }
     if(index_position.isEmpty()) { return index_position; }
 
     DEBUG(std::cout << "Starting with " << index_position << std::endl;)
@@ -681,7 +693,7 @@ FMD::fmdCount(const std::string& pattern, bool backward) const
     for(++iter; iter != pattern.rend(); ++iter)
     {
       // Backwards extend with subsequent characters.
-      index_position = this->extend(index_position, *iter, true);
+      index_position = this->extend(index_position, *iter, true, context);
       DEBUG(std::cout << "Now at " << index_position << " after " << *iter <<
         std::endl;)
       // Test out retracting
@@ -694,7 +706,15 @@ FMD::fmdCount(const std::string& pattern, bool backward) const
     // Start at the front of the pattern and work towards the end.
     
     std::string::const_iterator iter = pattern.begin();
-    index_position = this->getCharPosition((uchar)*iter);
+    if(this->getKmerPosition(pattern, 0, index_position))
+    {
+      // Start from the range of the first k characters.
+      iter += this->getKmerLength() - 1;
+    }
+    else
+    {
+      index_position = this->getCharPosition((uchar)*iter);
+    }
     if(index_position.isEmpty()) { return index_position; }
 
     DEBUG(std::cout << "Starting with " << index_position << std::endl;)
@@ -702,7 +722,7 @@ FMD::fmdCount(const std::string& pattern, bool backward) const
     for(++iter; iter != pattern.end(); ++iter)
     {
       // Forwards extend with subsequent characters.
-      index_position = this->extend(index_position, *iter, false);
+      index_position = this->extend(index_position, *iter, false, context);
       DEBUG(std::cout << "Now at " << index_position << " after " << *iter << 
         std::endl;)
       // Test out retracting
@@ -719,6 +739,14 @@ FMD::fmdCount(const std::string& pattern, bool backward) const
 
 std::pair<pair_type, usint>
 FMD::countUntilUnique(const std::string& pattern, usint index) const
+{
+  QueryContext context(*this);
+  return this->countUntilUnique(pattern, index, context);
+}
+
+std::pair<pair_type, usint>
+FMD::countUntilUnique(const std::string& pattern, usint index,
+  QueryContext& context) const
 {
   // Mostly copied from the RLCSA count method.
   
@@ -741,13 +769,25 @@ FMD::countUntilUnique(const std::string& pattern, usint index) const
     this->convertToSARange(index_range);
     return std::make_pair(index_range, index - i + 1);
   }
+  
+  FMDPosition kmer_position;
+  if(index + 1 >= this->getKmerLength() &&
+    this->getKmerPosition(pattern, index + 1 - this->getKmerLength(),
+    kmer_position) && kmer_position.getLength() > 1)
+  {
+    // The whole k-mer still matches in several places, so none of its suffixes
+    // can be unique. Skip to the start of the k-mer.
+    i = index + 1 - this->getKmerLength();
+    index_range = pair_type(kmer_position.forward_start,
+      kmer_position.forward_start + kmer_position.end_offset);
+  }
 
   for(--i; i >= 0; --i)
   {
     // For each base going left...
   
     // Apply the LF mapping to shrink the range.
-    index_range = this->LF(index_range, (uchar)pattern[i]);
+    index_range = this->LF(index_range, (uchar)pattern[i], context);
     
     // Stop if we're empty.
     if(isEmpty(index_range)) {
@@ -771,6 +811,14 @@ FMD::countUntilUnique(const std::string& pattern, usint index) const
 
 MapAttemptResult
 FMD::mapPosition(const std::string& pattern, usint index) const
+{
+  QueryContext context(*this);
+  return this->mapPosition(pattern, index, context);
+}
+
+MapAttemptResult
+FMD::mapPosition(const std::string& pattern, usint index,
+  QueryContext& context) const
 {
   DEBUG(std::cout << "Mapping " << index << " in " << pattern << std::endl;)
   
@@ -798,6 +846,18 @@ FMD::mapPosition(const std::string& pattern, usint index) const
     return result;
   }
 
+  FMDPosition kmer_position;
+  if(index + 1 >= this->getKmerLength() &&
+    this->getKmerPosition(pattern, index + 1 - this->getKmerLength(),
+    kmer_position) && kmer_position.getLength() > 1)
+  {
+    // The whole k-mer still maps to several places, so every shorter extension
+    // would have too. Jump to the start of the k-mer.
+    result.position = kmer_position;
+    result.characters = this->getKmerLength();
+    index = index + 1 - this->getKmerLength();
+  }
+
   if(index == 0) {
     // The rest of the function deals with characters to the left of the one we
     // start at. If we start at position 0 there can be none.
@@ -819,7 +879,7 @@ FMD::mapPosition(const std::string& pattern, usint index) const
     
     // Backwards extend with subsequent characters.
     FMDPosition next_position = this->extend(result.position, character,
-      true);
+      true, context);
     extends++;
       
     DEBUG(std::cout << "Now at " << next_position << " after " << 
@@ -859,6 +919,14 @@ FMD::mapPosition(const std::string& pattern, usint index) const
 MapAttemptResult
 FMD::mapPosition(const RangeVector& ranges, const std::string& pattern, 
   usint index) const
+{
+  QueryContext context(*this);
+  return this->mapPosition(ranges, pattern, index, context);
+}
+
+MapAttemptResult
+FMD::mapPosition(const RangeVector& ranges, const std::string& pattern, 
+  usint index, QueryContext& context) const
 {
   // We're going to right-map so ranges match up with the things we can map to
   // (downstream contexts)
@@ -887,13 +955,24 @@ FMD::mapPosition(const RangeVector& ranges, const std::string& pattern,
     return result;
   }
 
+  FMDPosition kmer_position;
+  if(this->getKmerPosition(pattern, index, kmer_position) &&
+    !kmer_position.isEmpty() && kmer_position.range(ranges) == -1)
+  {
+    // The whole k-mer still spans several ranges, and so did all of its
+    // prefixes. Jump to the end of the k-mer.
+    result.position = kmer_position;
+    result.characters = this->getKmerLength();
+    index += this->getKmerLength() - 1;
+  }
+
   DEBUG(std::cout << "Starting with " << result.position << std::endl;)
 
   for(index++; index < pattern.size(); index++)
   {
     // Forwards extend with subsequent characters.
     FMDPosition next_position = this->extend(result.position, pattern[index],
-      false);
+      false, context);
     extends++;
       
     DEBUG(std::cout << "Now at " << next_position << " after " << 
@@ -949,6 +1028,12 @@ FMD::map(const std::string& query, usint start, sint length) const
   // Other fields get overwritten.
   location.position = EMPTY_FMD_POSITION;
   
+  // Reuse the same iterators for all extensions.
+  QueryContext context(*this);
+
+  // SA values of the mapped bases, and the indexes of their Mappings.
+  std::vector<usint> located, mapped;
+  
   for(sint i = start; i < (sint)(start + length); i++)
   {
     if(location.position.isEmpty())
@@ -957,7 +1042,7 @@ FMD::map(const std::string& query, usint start, sint length) const
         std::endl;)
       // We do not currently have a non-empty FMDPosition to extend. Start over
       // by mapping this character by itself.
-      location = this->mapPosition(query, i);
+      location = this->mapPosition(query, i, context);
       restarts++;
     }
     else
@@ -966,7 +1051,8 @@ FMD::map(const std::string& query, usint start, sint length) const
       // The last base either mapped successfully or failed due to multi-
       // mapping. Try to extend the FMDPosition we have to the right (not
       // backwards) with the next base.
-      location.position = this->extend(location.position, query[i], false);
+      location.position = this->extend(location.position, query[i], false,
+        context);
       extends++;
       location.characters++;
     }
@@ -981,23 +1067,22 @@ FMD::map(const std::string& query, usint start, sint length) const
       usint converted_start = location.position.forward_start;
       convertToSAIndex(converted_start);
       
-      // Locate it, and then report position as a (text, offset) pair. This will
-      // give us the position of the first base in the pattern, which lets us
-      // infer the position of the last base in the pattern.
-      pair_type text_location = getRelativePosition(locate(converted_start));
+      // Locate it. The SA value is converted to a (text, offset) pair after
+      // the loop. This will give us the position of the first base in the
+      // pattern, which lets us infer the position of the last base in the
+      // pattern.
+      located.push_back(locate(converted_start, context));
         
       INFO(std::cout << "Mapped " << location.characters << 
-        " context to text " << text_location.first << " position " << 
-        text_location.second << std::endl;)
+        " context to position " << located.back() << std::endl;)
         
       // Correct to the position of the last base in the pattern, by offsetting
       // by the length of the pattern that was used. A 2-character pattern means
       // we need to go 1 further right in the string it maps to to find where
-      // its rightmost character maps.
-      text_location.second += (location.characters - 1);
-      
-      // Add a Mapping for this mapped base.
-      mappings.push_back(Mapping(text_location));
+      // its rightmost character maps. For now, the Mapping only holds the
+      // offset.
+      mapped.push_back(mappings.size());
+      mappings.push_back(Mapping(pair_type(0, location.characters - 1)));
       
       // We definitely have a non-empty FMDPosition to continue from
       
@@ -1046,6 +1131,9 @@ FMD::map(const std::string& query, usint start, sint length) const
   
   }
   
+  // Convert the SA values of all mapped bases at once.
+  this->addTextLocations(located, mapped, mappings);
+  
   // We've gone through and attempted the whole string. Give back our answers.
   return mappings;
   
@@ -1066,34 +1154,40 @@ FMD::mapFM(const std::string& query, usint start, sint length) const
   // We need a vector to return.
   std::vector<Mapping> mappings;
   
+  // Reuse the same iterators for all searches.
+  QueryContext context(*this);
+
+  // SA values of the mapped bases, and the indexes of their Mappings.
+  std::vector<usint> located, mapped;
+  
   for(sint i = start; i < (sint)(start + length); i++)
   {
     // For each base to map...
 
     // Count left from there until we don't need to any more.
-    std::pair<pair_type, usint> countResult = countUntilUnique(query, i);
+    std::pair<pair_type, usint> countResult = countUntilUnique(query, i,
+      context);
     pair_type range = countResult.first;
     usint characters = countResult.second;
     
     if(range.first == range.second) {
       // We successfully mapped to just one place.
       
-      // Locate it, and then report position as a (text, offset) pair. This will
-      // give us the position of the first base in the pattern, which lets us
-      // infer the position of the last base in the pattern.
-      pair_type text_location = getRelativePosition(locate(range.first));
+      // Locate it. The SA value is converted to a (text, offset) pair after
+      // the loop. This will give us the position of the first base in the
+      // pattern, which lets us infer the position of the last base in the
+      // pattern.
+      located.push_back(locate(range.first, context));
         
-      INFO(std::cout << "Mapped to text " << text_location.first << 
-        " position " << text_location.second << std::endl;)
+      INFO(std::cout << "Mapped to position " << located.back() << std::endl;)
         
       // Correct to the position of the last base in the pattern, by offsetting
       // by the length of the pattern that was used. A 2-character pattern means
       // we need to go 1 further right in the string it maps to to find where
-      // its rightmost character maps.
-      text_location.second += (characters - 1);
-      
-      // Add a Mapping for this mapped base.
-      mappings.push_back(Mapping(text_location));
+      // its rightmost character maps. For now, the Mapping only holds the
+      // offset.
+      mapped.push_back(mappings.size());
+      mappings.push_back(Mapping(pair_type(0, characters - 1)));
       
     } else {
       // We mapped to multiple or no places: no results
@@ -1102,6 +1196,9 @@ FMD::mapFM(const std::string& query, usint start, sint length) const
     }
   }
   
+  // Convert the SA values of all mapped bases at once.
+  this->addTextLocations(located, mapped, mappings);
+  
   // We've gone through and attempted the whole string. Give back our answers.
   return mappings;
   
@@ -1131,6 +1228,9 @@ FMD::map(const RangeVector& ranges, const std::string& query, usint start,
   // Make sure the scratch position is empty so we re-start on the first base
   location.position = EMPTY_FMD_POSITION;
   
+  // Reuse the same iterators for all extensions.
+  QueryContext context(*this);
+  
   for(sint i = start + length - 1; i >= (sint) start; i--)
   {
     // Go from the end of our selected region to the beginning.
@@ -1141,7 +1241,7 @@ FMD::map(const RangeVector& ranges, const std::string& query, usint start,
         std::endl;)
       // We do not currently have a non-empty FMDPosition to extend. Start over
       // by mapping this character by itself.
-      location = this->mapPosition(ranges, query, i);
+      location = this->mapPosition(ranges, query, i, context);
       restarts++;
     }
     else
@@ -1150,7 +1250,8 @@ FMD::map(const RangeVector& ranges, const std::string& query, usint start,
       // The last base either mapped successfully or failed due to multi-
       // mapping. Try to extend the FMDPosition we have to the left (backwards)
       // with the next base.
-      location.position = this->extend(location.position, query[i], true);
+      location.position = this->extend(location.position, query[i], true,
+        context);
       extends++;
       location.characters++;
     }
@@ -1292,4 +1393,45 @@ FMD::convertToSAPosition(FMDPosition& bwt_position) const
   bwt_position.reverse_start -= this->number_of_sequences;
 }
 
+void
+FMD::addTextLocations(const std::vector<usint>& located,
+  const std::vector<usint>& mapped, std::vector<Mapping>& mappings) const
+{
+  if(located.empty()) { return; }
+  
+  pair_type* text_locations = this->getRelativePosition(&(located[0]),
+    located.size());
+  for(usint i = 0; i < located.size(); i++)
+  {
+    Mapping& mapping = mappings[mapped[i]];
+    mapping.location.first = text_locations[i].first;
+    mapping.location.second += text_locations[i].second;
+  }
+  delete[] text_locations;
+}
+
+bool
+FMD::getKmerPosition(const std::string& pattern, usint offset,
+  FMDPosition& position) const
+{
+  if(this->kmer_table == 0) { return false; }
+  
+  usint code = this->kmer_table->encode(pattern, offset);
+  if(code == KmerTable::NOT_A_KMER) { return false; }
+  
+  pair_type forward_range = this->kmer_table->getRange(code);
+  if(isEmpty(forward_range))
+  {
+    position = EMPTY_FMD_POSITION;
+  }
+  else
+  {
+    // The table stores the start of the reverse complement range as well, so
+    // this is a complete bi-interval.
+    position = FMDPosition(forward_range.first,
+      this->kmer_table->getReverseStart(code), length(forward_range) - 1);
+  }
+  return true;
+}
+
 }
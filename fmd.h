@@ -392,7 +392,8 @@ class FMD : public RLCSA
   public:
     // We can only be constructed on a previously generated RLCSA index that
     // just happens to meet our requirements.
-    explicit FMD(const std::string& base_name, bool print = false);
+    // The parameters are passed to the RLCSA constructor.
+    explicit FMD(const std::string& base_name, bool print = false, bool memory_map = false, usint threads = 1);
     
     /**
      * Extend a search by a character, either backward or forward. Ranges are in
@@ -400,6 +401,13 @@ class FMD : public RLCSA
      */
     FMDPosition extend(FMDPosition range, usint c, bool backward) const;
     
+    /**
+     * As above, but uses the iterators in the given QueryContext instead of
+     * constructing new ones.
+     */
+    FMDPosition extend(FMDPosition range, usint c, bool backward,
+      QueryContext& context) const;
+    
     /**
      * Retract a search by a character, either backward or forward. Reverses a
      * call to extend, but can also retract one way when the extend call was
@@ -423,6 +431,8 @@ class FMD : public RLCSA
      */
     std::pair<pair_type, usint> countUntilUnique(const std::string& pattern,
       usint index) const;
+    std::pair<pair_type, usint> countUntilUnique(const std::string& pattern,
+      usint index, QueryContext& context) const;
       
     /**
      * Try left-mapping the given index in the given string, starting from
@@ -440,6 +450,8 @@ class FMD : public RLCSA
      */
     MapAttemptResult mapPosition(const std::string& pattern,
       usint index) const;
+    MapAttemptResult mapPosition(const std::string& pattern,
+      usint index, QueryContext& context) const;
       
     /**
      * Try RIGHT-mapping the given index in the given string to a unique forward-
@@ -462,6 +474,8 @@ class FMD : public RLCSA
      */
     MapAttemptResult mapPosition(const RangeVector& ranges, 
       const std::string& pattern, usint index) const;
+    MapAttemptResult mapPosition(const RangeVector& ranges, 
+      const std::string& pattern, usint index, QueryContext& context) const;
       
     /**
      * Attempt to map each base in the query string to a (text, position) pair.
@@ -568,6 +582,30 @@ class FMD : public RLCSA
      * place.
      */
     void convertToSAPosition(FMDPosition& bwt_position) const;
+    
+    /**
+     * Convert the located SA values to (text, offset) pairs in one batch, and
+     * add them to the Mappings with the given indexes, which hold the offsets
+     * of the last bases.
+     */
+    void addTextLocations(const std::vector<usint>& located,
+      const std::vector<usint>& mapped, std::vector<Mapping>& mappings) const;
+    
+    /**
+     * Get the FMDPosition in BWT coordinates for the k-mer starting at offset
+     * in pattern from the k-mer table. Returns false if there is no table or
+     * the k-mer is not in it; the position is then left unchanged.
+     */
+    bool getKmerPosition(const std::string& pattern, usint offset,
+      FMDPosition& position) const;
+    
+    /**
+     * Get the k of the k-mer table, or 0 if there is no table.
+     */
+    inline usint getKmerLength() const
+    {
+      return (this->kmer_table != 0 ? this->kmer_table->getK() : 0);
+    }
   
     // These are not allowed.
     FMD();
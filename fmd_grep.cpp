@@ -216,11 +216,12 @@ void print_results(pair_type result_range, const FMD& fmd, mode_type mode, usint
   }
   else if(mode == RELATIVE)
   {
+    pair_type* relative = fmd.getRelativePosition(results, occurrences);
     for(usint i = 0; i < occurrences; i++)
     {
-      pair_type relative = fmd.getRelativePosition(results[i]);
-      std::cout << relative.first << ", " << relative.second << std::endl;
+      std::cout << relative[i].first << ", " << relative[i].second << std::endl;
     }
+    delete[] relative;
   }
   else if(mode == CONTEXT)
   {
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#include "container.h"
+#include "kmertable.h"
+#include "rlcsa.h"
+
+#ifdef MULTITHREAD_SUPPORT
+#include <omp.h>
+#endif
+
+
+namespace CSA
+{
+
+
+KmerTable::KmerTable(const RLCSA& rlcsa, usint _k, usint threads) :
+  k(_k), kmers(0), entries(0),
+  mapping(0), mapping_size(0),
+  ok(false)
+{
+  if(!(rlcsa.isOk())) { return; }
+  if(this->k < MIN_K || this->k > MAX_K)
+  {
+    std::cerr << "KmerTable: k must be between " << MIN_K << " and " << MAX_K << "!" << std::endl;
+    return;
+  }
+  this->kmers = (usint)1 << (2 * this->k);
+
+  const uchar bases[4] = { 'A', 'C', 'G', 'T' };
+  pair_type* ranges = new pair_type[this->kmers];
+  pair_type* next = new pair_type[this->kmers];
+  for(usint b = 0; b < 4; b++) { ranges[b] = rlcsa.getCharRange(bases[b]); }
+
+  // Extend all (len - 1)-mers x to bx by backward searching. The code of bx is
+  // b * 4^(len - 1) + code(x).
+  for(usint len = 2; len <= this->k; len++)
+  {
+    usint prev_kmers = (usint)1 << (2 * (len - 1));
+    #ifdef MULTITHREAD_SUPPORT
+    omp_set_num_threads(threads);
+    #pragma omp parallel
+    #endif
+    {
+      QueryContext context(rlcsa);
+      #ifdef MULTITHREAD_SUPPORT
+      #pragma omp for schedule(static)
+      #endif
+      for(sint x = 0; x < (sint)prev_kmers; x++)
+      {
+        for(usint b = 0; b < 4; b++)
+        {
+          pair_type range = EMPTY_PAIR;
+          if(!isEmpty(ranges[x])) { range = rlcsa.LF(ranges[x], bases[b], context); }
+          next[b * prev_kmers + x] = range;
+        }
+      }
+    }
+    std::swap(ranges, next);
+  }
+  delete[] next;
+
+  usint width = length(rlcsa.getSize() + rlcsa.getNumberOfSequences());
+  WriteBuffer buffer(ENTRY_SIZE * this->kmers, width);
+  for(usint code = 0; code < this->kmers; code++)
+  {
+    // The reverse complement reverses the order of the bases and maps b to 3 - b.
+    usint rc_code = 0;
+    for(usint i = 0, temp = code; i < this->k; i++, temp >>= 2)
+    {
+      rc_code = (rc_code << 2) | (3 - (temp & 3));
+    }
+
+    pair_type range = ranges[code];
+    if(isEmpty(range)) { buffer.writeItem(0); }
+    else               { buffer.writeItem(range.first); }
+    if(isEmpty(ranges[rc_code])) { buffer.writeItem(0); }
+    else                         { buffer.writeItem(ranges[rc_code].first); }
+    buffer.writeItem(isEmpty(range) ? 0 : length(range));
+  }
+  delete[] ranges;
+
+  this->entries = buffer.getReadBuffer();
+  this->identity = rlcsa.getIdentity();
+  this->ok = true;
+}
+
+KmerTable::KmerTable(const std::string& base_name, const RLCSA& rlcsa) :
+  k(0), kmers(0), entries(0),
+  mapping(0), mapping_size(0),
+  ok(false)
+{
+  this->mapping = mapIndexFile(base_name, KMER_TABLE_EXTENSION);
+  if(this->mapping == 0 || !(this->mapping->isOk()))
+  {
+    std::cerr << "KmerTable: Error mapping k-mer table file!" << std::endl;
+    return;
+  }
+  this->mapping_size = this->mapping->getSize() * sizeof(usint);
+  if(this->mapping->getSize() < HEADER_WORDS + INDEX_IDENTITY_WORDS)
+  {
+    std::cerr << "KmerTable: Invalid k-mer table file!" << std::endl;
+    return;
+  }
+
+  const usint* header = this->mapping->readWords(HEADER_WORDS);
+  this->k = header[0];
+  usint width = header[1];
+  if(this->k < MIN_K || this->k > MAX_K || width == 0 || width > WORD_BITS)
+  {
+    std::cerr << "KmerTable: Invalid k-mer table header!" << std::endl;
+    return;
+  }
+  this->kmers = (usint)1 << (2 * this->k);
+  usint words = BITS_TO_WORDS(ENTRY_SIZE * this->kmers * width);
+  if(this->mapping_size != (HEADER_WORDS + INDEX_IDENTITY_WORDS + words) * sizeof(usint))
+  {
+    std::cerr << "KmerTable: Invalid k-mer table size!" << std::endl;
+    return;
+  }
+
+  this->identity.assign(header + HEADER_WORDS, header + HEADER_WORDS + INDEX_IDENTITY_WORDS);
+  if(this->identity != rlcsa.getIdentity())
+  {
+    std::cerr << "KmerTable: The k-mer table was built for another index!" << std::endl;
+    return;
+  }
+
+  this->entries = new ReadBuffer(header + HEADER_WORDS + INDEX_IDENTITY_WORDS, ENTRY_SIZE * this->kmers, width);
+  this->ok = true;
+}
+
+KmerTable::~KmerTable()
+{
+  delete this->entries; this->entries = 0;
+  delete this->mapping; this->mapping = 0;
+}
+
+//--------------------------------------------------------------------------
+
+void
+KmerTable::writeTo(const std::string& base_name) const
+{
+  if(!(this->ok)) { return; }
+
+  std::string table_name = base_name + KMER_TABLE_EXTENSION;
+  std::ofstream table_file(table_name.c_str(), std::ios_base::binary);
+  if(!table_file)
+  {
+    std::cerr << "KmerTable: Error creating k-mer table file!" << std::endl;
+    return;
+  }
+
+  usint width = this->entries->getItemSize();
+  table_file.write((char*)&(this->k), sizeof(this->k));
+  table_file.write((char*)&width, sizeof(width));
+  table_file.write((char*)&(this->identity[0]), INDEX_IDENTITY_WORDS * sizeof(usint));
+  this->entries->writeBuffer(table_file);
+  table_file.close();
+}
+
+usint
+KmerTable::reportSize() const
+{
+  usint bytes = sizeof(*this) + this->identity.capacity() * sizeof(usint);
+  if(this->entries != 0) { bytes += this->entries->reportSize(); }
+  bytes += this->mapping_size;  // The mapped entries are not owned by the buffer.
+  return bytes;
+}
+
+
+} // namespace CSA
@@ -0,0 +1,121 @@
+#ifndef KMERTABLE_H
+#define KMERTABLE_H
+
+#include <string>
+#include <vector>
+
+#include "misc/definitions.h"
+#include "bits/bitbuffer.h"
+
+
+namespace CSA
+{
+
+
+class RLCSA;
+
+
+/*
+  A table of the BWT ranges of all k-mers over {A, C, G, T}. Searches can start from
+  the range of the last k characters of the pattern instead of doing k LF steps.
+
+  For k-mer P, the table stores the start of the BWT range of P, the start of the BWT
+  range of the reverse complement of P, and the number of occurrences. Together these
+  form an FMD bi-interval when the index contains the reverse complements of the
+  sequences.
+
+  The table is memory mapped when loaded from disk. The file stores the identity of
+  the index, and a table built for another index is not loaded.
+*/
+
+class KmerTable
+{
+  public:
+    const static usint MIN_K = 1;
+    const static usint MAX_K = 15;
+    const static usint NOT_A_KMER = ~((usint)0);
+
+    KmerTable(const RLCSA& rlcsa, usint _k, usint threads = 1);
+    KmerTable(const std::string& base_name, const RLCSA& rlcsa);
+    ~KmerTable();
+
+    void writeTo(const std::string& base_name) const;
+
+    inline bool isOk() const { return this->ok; }
+    inline usint getK() const { return this->k; }
+    inline usint getNumberOfKmers() const { return this->kmers; }
+
+    usint reportSize() const;
+
+//--------------------------------------------------------------------------
+
+    // Returns the code of pattern[offset, offset + k - 1], or NOT_A_KMER if the
+    // substring does not exist or contains other characters than ACGT.
+    inline usint encode(const std::string& pattern, usint offset) const
+    {
+      if(offset + this->k > pattern.length()) { return NOT_A_KMER; }
+      usint code = 0;
+      for(usint i = offset; i < offset + this->k; i++)
+      {
+        usint base = baseCode((uchar)pattern[i]);
+        if(base >= 4) { return NOT_A_KMER; }
+        code = (code << 2) | base;
+      }
+      return code;
+    }
+
+    // BWT range of the k-mer, or EMPTY_PAIR if it does not occur.
+    inline pair_type getRange(usint code) const
+    {
+      usint count = this->entries->readItemConst(ENTRY_SIZE * code + 2);
+      if(count == 0) { return EMPTY_PAIR; }
+      usint start = this->entries->readItemConst(ENTRY_SIZE * code);
+      return pair_type(start, start + count - 1);
+    }
+
+    // Start of the BWT range of the reverse complement of the k-mer.
+    inline usint getReverseStart(usint code) const
+    {
+      return this->entries->readItemConst(ENTRY_SIZE * code + 1);
+    }
+
+//--------------------------------------------------------------------------
+
+  protected:
+    const static usint ENTRY_SIZE = 3;
+    const static usint HEADER_WORDS = 2;
+
+    inline static usint baseCode(usint c)
+    {
+      switch(c)
+      {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default:  return 4;
+      }
+    }
+
+    usint       k, kmers;
+    ReadBuffer* entries;
+
+    std::vector<usint> identity;
+
+    // The memory mapped file. Both are 0 if the table was built in memory.
+    FileMap*    mapping;
+    usint       mapping_size;
+
+    bool        ok;
+
+    // These are not allowed.
+    KmerTable();
+    KmerTable(const KmerTable&);
+    KmerTable& operator = (const KmerTable&);
+};
+
+
+} // namespace CSA
+
+
+#endif // KMERTABLE_H
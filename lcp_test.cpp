@@ -4,6 +4,7 @@
 #include <fstream>
 #include <iostream>
 
+#include "container.h"
 #include "rlcsa.h"
 #include "misc/utils.h"
 
@@ -75,9 +76,8 @@ int main(int argc, char** argv)
   PLCPVector* plcp = 0;
   if(mode_plcp)
   {
-    std::string plcp_name = base_name + PLCP_EXTENSION;
-    std::ifstream plcp_file(plcp_name.c_str(), std::ios_base::binary);
-    if(!plcp_file)
+    std::ifstream plcp_file;
+    if(!openIndexFile(base_name, PLCP_EXTENSION, plcp_file))
     {
       std::cerr << "Error: Cannot open PLCP file!" << std::endl;
       return 3;
@@ -90,9 +90,8 @@ int main(int argc, char** argv)
   LCPSamples* lcp = 0;
   if(mode_sampled)
   {
-    std::string lcp_name = base_name + LCP_SAMPLES_EXTENSION;
-    std::ifstream lcp_file(lcp_name.c_str(), std::ios_base::binary);
-    if(!lcp_file)
+    std::ifstream lcp_file;
+    if(!openIndexFile(base_name, LCP_SAMPLES_EXTENSION, lcp_file))
     {
       std::cerr << "Error: Cannot open LCP sample file!" << std::endl;
       delete plcp;
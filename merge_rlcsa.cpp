@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -82,7 +83,7 @@ main(int argc, char** argv)
   
   double mark = readTimer();
   std::cout << "Load: " << base_name; std::cout.flush();
-  RLCSA* originalIndex = new RLCSA(base_name);
+  RLCSA* originalIndex = new RLCSA(base_name, false, false, threads);
   RLCSABuilder builder(parameters.get(RLCSA_BLOCK_SIZE), parameters.get(SAMPLE_RATE), 0, threads, originalIndex);
   std::cout << " (" << (readTimer() - mark) << " seconds)" << std::endl;
   
@@ -120,6 +121,9 @@ getRLCSA(RLCSABuilder& builder, const std::string& base_name)
     index->printInfo();
     index->reportSize(true);
     index->writeTo(base_name);
+    std::remove((base_name + RUN_SAMPLES_EXTENSION).c_str());
+    std::remove((base_name + SAMPLE_CACHE_EXTENSION).c_str());
+    std::remove((base_name + KMER_TABLE_EXTENSION).c_str());
     megabytes = index->getSize() / (double)MEGABYTE;
   }
 
@@ -23,6 +23,12 @@ inline usint popcount(usint field)
   return __builtin_popcountl(field);
 }
 
+// Undefined for field == 0.
+inline usint leadingZeros(usint field)
+{
+  return __builtin_clzl(field);
+}
+
 #else
 
 typedef unsigned int  usint;
@@ -33,6 +39,12 @@ inline usint popcount(usint field)
   return __builtin_popcount(field);
 }
 
+// Undefined for field == 0.
+inline usint leadingZeros(usint field)
+{
+  return __builtin_clz(field);
+}
+
 #endif
 
 
@@ -41,15 +41,15 @@ Parameters::set(const parameter_type& param)
 }
 
 void
-Parameters::read(std::ifstream& file)
+Parameters::read(std::istream& stream)
 {
-  while(file)
+  while(stream)
   {
     std::string key;
     std::string c;
     usint value;
 
-    file >> key >> c >> value;
+    stream >> key >> c >> value;
     if(c == "=") { this->parameters[key] = value; }
   }
 }
@@ -27,7 +27,7 @@ class Parameters
     void set(const std::string& key, usint value);
     void set(const parameter_type& param);
 
-    void read(std::ifstream& file);
+    void read(std::istream& stream);
     void read(FILE* file);
     void read(const std::string& file_name);
     void print() const;
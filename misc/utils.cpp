@@ -63,6 +63,13 @@ largeWrite(std::ofstream& file, char* data, std::streamoff size, std::streamoff
 	}
 }
 
+usint
+hashWords(const usint* data, usint words, usint hash)
+{
+  for(usint i = 0; i < words; i++) { hash = (hash ^ data[i]) * (usint)0x100000001B3ULL; }
+  return hash;
+}
+
 //--------------------------------------------------------------------------
 
 void
@@ -123,6 +130,16 @@ memoryUsage()
   return usage.ru_maxrss;
 }
 
+usint
+maxThreads()
+{
+  #ifdef MULTITHREAD_SUPPORT
+  return omp_get_max_threads();
+  #else
+  return 1;
+  #endif
+}
+
 //--------------------------------------------------------------------------
 
 typedef std::pair<uint, uint> ss_range;
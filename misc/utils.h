@@ -43,6 +43,10 @@ std::streamoff fileSize(std::ofstream& file);
 // Block size is in megabytes.
 void largeWrite(std::ofstream& file, char* data, std::streamoff size, std::streamoff block_size);
 
+// FNV-1a over words. Continues from the given hash value.
+const usint WORD_HASH_OFFSET = (usint)0xCBF29CE484222325ULL;
+usint hashWords(const usint* data, usint words, usint hash = WORD_HASH_OFFSET);
+
 //--------------------------------------------------------------------------
 
 template<class A, class B>
@@ -58,6 +62,7 @@ void readPizzaChili(std::ifstream& file, std::vector<std::string>& patterns);
 
 double readTimer();
 usint  memoryUsage(); // Peak memory usage in kilobytes.
+usint  maxThreads();  // 1 without MULTITHREAD_SUPPORT.
 
 //--------------------------------------------------------------------------
 
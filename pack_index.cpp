@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "container.h"
+#include "rlcsa.h"
+#include "misc/utils.h"
+
+
+using namespace CSA;
+
+
+/*
+  This program packs the files of an existing index into a single container file
+  base_name + CONTAINER_EXTENSION. The files that do not exist are skipped. The
+  container is loaded instead of the separate files, so the separate files can be
+  removed after packing. Tools that write index files still write separate files.
+  Loaders use such a file instead of its section, until the index is packed again.
+  When packing again, the sections of the existing container are kept, unless the
+  separate file is newer.
+*/
+
+
+const std::string COMPONENTS[] =
+{
+  PARAMETERS_EXTENSION, ARRAY_EXTENSION, SA_SAMPLES_EXTENSION, RUN_SAMPLES_EXTENSION,
+  SAMPLE_CACHE_EXTENSION, KMER_TABLE_EXTENSION, DOCUMENT_EXTENSION, LCP_SAMPLES_EXTENSION,
+  PLCP_EXTENSION
+};
+const usint NUMBER_OF_COMPONENTS = sizeof(COMPONENTS) / sizeof(COMPONENTS[0]);
+
+
+bool
+checkContainer(const std::string& file_name)
+{
+  IndexContainer container(file_name);
+  if(!(container.isOk())) { return false; }
+
+  bool ok = true;
+  for(usint i = 0; i < container.getNumberOfSections(); i++)
+  {
+    const IndexContainer::Section& section = container.getSection(i);
+    bool valid = container.verify(section.name);
+    std::cout << "  " << section.name << ": " << section.size << " bytes at offset " << section.offset
+              << (valid ? "" : " (checksum mismatch)") << std::endl;
+    ok &= valid;
+  }
+  return ok;
+}
+
+
+int
+main(int argc, char** argv)
+{
+  std::cout << "Index packer" << std::endl;
+  std::cout << "Options: r (remove the separate files), c (check an existing container)" << std::endl;
+  if(argc < 2)
+  {
+    std::cout << "Usage: pack_index [-rc] base_name" << std::endl;
+    return 1;
+  }
+
+  bool remove_files = false, check_only = false;
+  int arg = 1;
+  if(argv[arg][0] == '-')
+  {
+    for(usint i = 1; argv[arg][i] != 0; i++)
+    {
+      switch(argv[arg][i])
+      {
+        case 'r':
+          remove_files = true; break;
+        case 'c':
+          check_only = true; break;
+        default:
+          std::cout << "Invalid option: " << argv[arg][i] << std::endl;
+          return 1;
+      }
+    }
+    arg++;
+  }
+  if(arg >= argc)
+  {
+    std::cout << "Usage: pack_index [-rc] base_name" << std::endl;
+    return 1;
+  }
+
+  std::string base_name = argv[arg];
+  std::string container_name = base_name + CONTAINER_EXTENSION;
+  std::cout << "Base name: " << base_name << std::endl;
+  std::cout << "Container: " << container_name << std::endl;
+  std::cout << std::endl;
+
+  double start = readTimer();
+  if(check_only)
+  {
+    bool ok = checkContainer(container_name);
+    std::cout << std::endl;
+    std::cout << "Container " << (ok ? "is valid" : "is corrupted") << " (" << (readTimer() - start) << " seconds)" << std::endl;
+    std::cout << std::endl;
+    return (ok ? 0 : 2);
+  }
+
+  bool found[NUMBER_OF_COMPONENTS], packed[NUMBER_OF_COMPONENTS];
+  IndexContainer old_container(container_name);
+  ContainerWriter writer(container_name);
+  for(usint i = 0; i < NUMBER_OF_COMPONENTS; i++)
+  {
+    std::ifstream file((base_name + COMPONENTS[i]).c_str(), std::ios_base::binary);
+    found[i] = file.good();
+    file.close();
+    bool in_container = (old_container.isOk() && old_container.findSection(COMPONENTS[i]) != 0);
+    if(in_container && !isNewerThanContainer(base_name, COMPONENTS[i]))
+    {
+      if(!(writer.copySection(old_container, COMPONENTS[i]))) { return 3; }
+    }
+    else if(found[i] && !(writer.addFile(COMPONENTS[i], base_name + COMPONENTS[i]))) { return 3; }
+    packed[i] = (found[i] || in_container);
+  }
+  if(!packed[0] || !packed[1])
+  {
+    std::cerr << "Error: The index must have parameter and Psi array files!" << std::endl;
+    return 3;
+  }
+  if(!(writer.close())) { return 3; }
+  double mark = readTimer();
+
+  bool ok = checkContainer(container_name);
+  std::cout << std::endl;
+  if(!ok)
+  {
+    std::cerr << "Error: The container is corrupted!" << std::endl;
+    return 4;
+  }
+
+  // The files are removed only after the container has been verified.
+  if(remove_files)
+  {
+    for(usint i = 0; i < NUMBER_OF_COMPONENTS; i++)
+    {
+      if(found[i]) { std::remove((base_name + COMPONENTS[i]).c_str()); }
+    }
+  }
+  double stop = readTimer();
+
+  std::cout << "Container written in " << (mark - start) << " seconds" << std::endl;
+  std::cout << "Container verified in " << (stop - mark) << " seconds" << std::endl;
+  if(remove_files) { std::cout << "Separate files removed" << std::endl; }
+  std::cout << std::endl;
+
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -83,6 +84,8 @@ main(int argc, char** argv)
   parameters.set(WEIGHTED_SAMPLES);
   parameters.read(parameters_name);
   parameters.print();
+  if(parameters.contains(PSI_ENCODING.first)) { PsiVector::setDefaultEncoding(parameters.get(PSI_ENCODING)); }
+  if(parameters.contains(SA_ENCODING.first)) { SAVector::setDefaultEncoding(parameters.get(SA_ENCODING)); }
 
   double start = readTimer();
   double megabytes = 0.0, build_time = 0.0;
@@ -145,6 +148,9 @@ getRLCSA(RLCSABuilder& builder, const std::string& base_name)
     index->printInfo();
     index->reportSize(true);
     index->writeTo(base_name);
+    std::remove((base_name + RUN_SAMPLES_EXTENSION).c_str());
+    std::remove((base_name + SAMPLE_CACHE_EXTENSION).c_str());
+    std::remove((base_name + KMER_TABLE_EXTENSION).c_str());
     megabytes = index->getSize() / (double)MEGABYTE;
   }
 
@@ -0,0 +1,779 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "container.h"
+#include "queryserver.h"
+
+
+namespace CSA
+{
+
+
+//--------------------------------------------------------------------------
+
+bool
+readFully(int fd, char* data, usint bytes)
+{
+  while(bytes > 0)
+  {
+    ssize_t result = recv(fd, data, bytes, 0);
+    if(result < 0 && errno == EINTR) { continue; }
+    if(result <= 0) { return false; }
+    data += result; bytes -= result;
+  }
+  return true;
+}
+
+bool
+writeFully(int fd, const char* data, usint bytes)
+{
+  while(bytes > 0)
+  {
+    ssize_t result = send(fd, data, bytes, MSG_NOSIGNAL);
+    if(result < 0 && errno == EINTR) { continue; }
+    if(result <= 0) { return false; }
+    data += result; bytes -= result;
+  }
+  return true;
+}
+
+inline void
+appendWords(std::vector<char>& buffer, const usint* words, usint n)
+{
+  buffer.insert(buffer.end(), (const char*)words, (const char*)(words + n));
+}
+
+inline void
+appendWord(std::vector<char>& buffer, usint word)
+{
+  appendWords(buffer, &word, 1);
+}
+
+// Parses the lengths and the patterns. Returns false if the payload is invalid.
+bool
+readPatterns(const std::vector<char>& payload, usint items, std::vector<std::string>& patterns)
+{
+  if(items == 0) { return payload.empty(); }
+  if(items > payload.size() / sizeof(usint)) { return false; }
+  const usint* lengths = (const usint*)&(payload[0]);
+  usint offset = items * sizeof(usint);
+  for(usint i = 0; i < items; i++)
+  {
+    if(lengths[i] > payload.size() - offset) { return false; }
+    patterns.push_back(std::string(&(payload[0]) + offset, lengths[i]));
+    offset += lengths[i];
+  }
+  return (offset == payload.size());
+}
+
+//--------------------------------------------------------------------------
+
+QueryServer::QueryServer(const std::vector<std::string>& base_names, usint _threads) :
+  threads(std::max(_threads, (usint)1)), reloader_started(false),
+  stopping(false), reload_requested(false), reloading(false), ok(false)
+{
+  pthread_mutex_init(&(this->lock), 0);
+  pthread_cond_init(&(this->wakeup), 0);
+  pthread_cond_init(&(this->done), 0);
+  pthread_mutex_init(&(this->version_lock), 0);
+  pthread_mutex_init(&(this->reload_lock), 0);
+
+  if(pipe(this->notify) != 0)
+  {
+    std::cerr << "QueryServer: Cannot create the notification pipe!" << std::endl;
+    this->notify[0] = this->notify[1] = -1;
+    return;
+  }
+  fcntl(this->notify[0], F_SETFL, O_NONBLOCK);
+  fcntl(this->notify[1], F_SETFL, O_NONBLOCK);
+
+  for(usint i = 0; i < base_names.size(); i++)
+  {
+    FMD* index = this->load(base_names[i]);
+    if(index == 0)
+    {
+      std::cerr << "QueryServer: Cannot load index " << i << " from " << base_names[i] << "!" << std::endl;
+      return;
+    }
+    Version* version = new Version;
+    version->index = index; version->base_name = base_names[i]; version->references = 1;
+    this->indexes.push_back(version);
+  }
+
+  for(usint i = 0; i < this->threads; i++)
+  {
+    pthread_t worker;
+    if(pthread_create(&worker, 0, workerMain, this) != 0)
+    {
+      std::cerr << "QueryServer: Cannot create worker threads!" << std::endl;
+      this->stop();
+      return;
+    }
+    this->workers.push_back(worker);
+  }
+
+  this->ok = true;
+}
+
+QueryServer::~QueryServer()
+{
+  this->stop();
+
+  pthread_mutex_lock(&(this->lock));
+  for(std::set<int>::iterator iter = this->active.begin(); iter != this->active.end(); ++iter)
+  {
+    shutdown(*iter, SHUT_RDWR);
+  }
+  pthread_cond_broadcast(&(this->wakeup));
+  pthread_mutex_unlock(&(this->lock));
+  for(usint i = 0; i < this->workers.size(); i++) { pthread_join(this->workers[i], 0); }
+  if(this->reloader_started) { pthread_join(this->reloader, 0); }
+
+  while(!(this->pending.empty())) { close(this->pending.front()); this->pending.pop_front(); }
+  while(!(this->returned.empty())) { close(this->returned.front()); this->returned.pop_front(); }
+  if(this->notify[0] >= 0) { close(this->notify[0]); close(this->notify[1]); }
+  for(usint i = 0; i < this->indexes.size(); i++) { this->release(this->indexes[i]); }
+  pthread_mutex_destroy(&(this->reload_lock));
+  pthread_mutex_destroy(&(this->version_lock));
+  pthread_cond_destroy(&(this->done));
+  pthread_cond_destroy(&(this->wakeup));
+  pthread_mutex_destroy(&(this->lock));
+}
+
+void
+QueryServer::stop()
+{
+  this->stopping = true;
+}
+
+void
+QueryServer::reloadAll()
+{
+  this->reload_requested = true;
+}
+
+//--------------------------------------------------------------------------
+
+FMD*
+QueryServer::load(const std::string& base_name) const
+{
+  FMD* index = new FMD(base_name, false, true, this->threads);
+  if(!(index->isOk()))
+  {
+    delete index;
+    return 0;
+  }
+  index->prefetch();
+
+  // Reject the index if its SA samples could not be loaded.
+  Parameters parameters;
+  readIndexParameters(base_name, parameters);
+  if((parameters.get(SUPPORT_LOCATE) && !(index->supportsLocate())) ||
+     (parameters.get(SUPPORT_DISPLAY) && !(index->supportsDisplay())))
+  {
+    std::cerr << "QueryServer: Cannot load the suffix array samples of " << base_name << "!" << std::endl;
+    delete index;
+    return 0;
+  }
+  return index;
+}
+
+QueryServer::Version*
+QueryServer::acquire(usint index)
+{
+  pthread_mutex_lock(&(this->version_lock));
+  Version* version = this->indexes[index];
+  version->references++;
+  pthread_mutex_unlock(&(this->version_lock));
+  return version;
+}
+
+void
+QueryServer::release(Version* version)
+{
+  pthread_mutex_lock(&(this->version_lock));
+  bool last = (--(version->references) == 0);
+  pthread_mutex_unlock(&(this->version_lock));
+
+  // The last user deletes the version outside the lock.
+  if(last)
+  {
+    delete version->index;
+    delete version;
+  }
+}
+
+bool
+QueryServer::reload(usint index, const std::string& base_name)
+{
+  if(index >= this->indexes.size()) { return false; }
+
+  pthread_mutex_lock(&(this->reload_lock));
+  std::string name = (base_name.empty() ? this->getBaseName(index) : base_name);
+  FMD* loaded = this->load(name);
+  if(loaded == 0)
+  {
+    std::cerr << "QueryServer: Cannot reload index " << index << " from " << name << "!" << std::endl;
+    pthread_mutex_unlock(&(this->reload_lock));
+    return false;
+  }
+
+  Version* version = new Version;
+  version->index = loaded; version->base_name = name; version->references = 1;
+  pthread_mutex_lock(&(this->version_lock));
+  Version* old = this->indexes[index];
+  this->indexes[index] = version;
+  pthread_mutex_unlock(&(this->version_lock));
+  pthread_mutex_unlock(&(this->reload_lock));
+
+  this->release(old);
+  return true;
+}
+
+std::string
+QueryServer::getBaseName(usint index)
+{
+  if(index >= this->indexes.size()) { return ""; }
+  Version* version = this->acquire(index);
+  std::string name = version->base_name;
+  this->release(version);
+  return name;
+}
+
+void*
+QueryServer::reloaderMain(void* server)
+{
+  QueryServer* self = (QueryServer*)server;
+  for(usint i = 0; i < self->indexes.size() && !(self->stopping); i++) { self->reload(i); }
+  self->reloading = false;
+  return 0;
+}
+
+//--------------------------------------------------------------------------
+
+bool
+QueryServer::serve(const std::string& socket_name)
+{
+  if(!(this->ok)) { return false; }
+
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(socket_name.length() >= sizeof(address.sun_path))
+  {
+    std::cerr << "QueryServer: Socket name " << socket_name << " is too long!" << std::endl;
+    return false;
+  }
+  strncpy(address.sun_path, socket_name.c_str(), sizeof(address.sun_path) - 1);
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(socket_name.c_str());
+  if(listener < 0 || bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0)
+  {
+    std::cerr << "QueryServer: Cannot listen on socket " << socket_name << "!" << std::endl;
+    if(listener >= 0) { close(listener); }
+    return false;
+  }
+
+  // Poll with a timeout, so that stop() and reloadAll() are noticed. The idle connections
+  // are polled here, and a connection with a request is queued to the workers.
+  std::vector<int> idle;
+  std::vector<pollfd> polled;
+  while(!(this->stopping))
+  {
+    if(this->reload_requested && !(this->reloading))
+    {
+      if(this->reloader_started) { pthread_join(this->reloader, 0); }
+      this->reload_requested = false; this->reloading = true;
+      this->reloader_started = (pthread_create(&(this->reloader), 0, reloaderMain, this) == 0);
+      if(!(this->reloader_started))
+      {
+        std::cerr << "QueryServer: Cannot create the reloader thread!" << std::endl;
+        this->reloading = false;
+      }
+    }
+
+    pthread_mutex_lock(&(this->lock));
+    idle.insert(idle.end(), this->returned.begin(), this->returned.end());
+    this->returned.clear();
+    pthread_mutex_unlock(&(this->lock));
+
+    polled.clear();
+    pollfd listen_request = { listener, POLLIN, 0 }; polled.push_back(listen_request);
+    pollfd notify_request = { this->notify[0], POLLIN, 0 }; polled.push_back(notify_request);
+    for(usint i = 0; i < idle.size(); i++)
+    {
+      pollfd connection_request = { idle[i], POLLIN, 0 };
+      polled.push_back(connection_request);
+    }
+    if(poll(&(polled[0]), polled.size(), 250) <= 0) { continue; }
+
+    if(polled[1].revents != 0)
+    {
+      char buffer[64];
+      while(read(this->notify[0], buffer, sizeof(buffer)) > 0) { }
+    }
+
+    // Readable or closed connections go to the workers.
+    usint still_idle = 0;
+    pthread_mutex_lock(&(this->lock));
+    for(usint i = 0; i < idle.size(); i++)
+    {
+      if(polled[i + 2].revents != 0) { this->pending.push_back(idle[i]); }
+      else { idle[still_idle] = idle[i]; still_idle++; }
+    }
+    if(still_idle < idle.size()) { pthread_cond_broadcast(&(this->wakeup)); }
+    pthread_mutex_unlock(&(this->lock));
+    idle.resize(still_idle);
+
+    if(polled[0].revents & POLLIN)
+    {
+      int connection = accept(listener, 0, 0);
+      if(connection < 0) { continue; }
+      timeval timeout = { (time_t)IO_TIMEOUT, 0 };
+      setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+      idle.push_back(connection);
+    }
+  }
+
+  for(usint i = 0; i < idle.size(); i++) { close(idle[i]); }
+  close(listener);
+  unlink(socket_name.c_str());
+  return true;
+}
+
+void*
+QueryServer::workerMain(void* server)
+{
+  ((QueryServer*)server)->work();
+  return 0;
+}
+
+void
+QueryServer::work()
+{
+  while(true)
+  {
+    pthread_mutex_lock(&(this->lock));
+    while(this->pending.empty() && this->batches.empty() && !(this->stopping))
+    {
+      pthread_cond_wait(&(this->wakeup), &(this->lock));
+    }
+    if(this->stopping)
+    {
+      pthread_mutex_unlock(&(this->lock));
+      return;
+    }
+
+    // New requests come first. Otherwise help with a batch another worker is answering.
+    if(this->pending.empty())
+    {
+      Request& request = *(this->batches.front());
+      usint chunk = this->claimChunk(request);
+      pthread_mutex_unlock(&(this->lock));
+      this->processChunk(request, chunk);
+      pthread_mutex_lock(&(this->lock));
+      request.finished++;
+      if(request.finished >= request.chunks) { pthread_cond_broadcast(&(this->done)); }
+      pthread_mutex_unlock(&(this->lock));
+      continue;
+    }
+
+    int connection = this->pending.front(); this->pending.pop_front();
+    this->active.insert(connection);
+    pthread_mutex_unlock(&(this->lock));
+
+    bool keep = this->serveRequest(connection);
+
+    pthread_mutex_lock(&(this->lock));
+    this->active.erase(connection);
+    keep = keep && !(this->stopping);
+    if(keep) { this->returned.push_back(connection); }
+    pthread_mutex_unlock(&(this->lock));
+    if(keep)
+    {
+      char byte = 0;
+      if(write(this->notify[1], &byte, 1) < 0) { }  // The pipe may already be full.
+    }
+    else { close(connection); }
+  }
+}
+
+bool
+QueryServer::serveRequest(int connection)
+{
+  usint header[REQUEST_HEADER_WORDS];
+  if(!readFully(connection, (char*)header, sizeof(header))) { return false; }
+  if(header[3] > MAX_PAYLOAD) { return false; }
+  std::vector<char> payload(header[3]), response;
+  if(header[3] > 0 && !readFully(connection, &(payload[0]), header[3])) { return false; }
+
+  usint result[RESPONSE_HEADER_WORDS] = { this->process(header, payload, response), header[2], 0 };
+  if(result[0] != OK) { response.clear(); }
+  result[2] = response.size();
+  if(!writeFully(connection, (const char*)result, sizeof(result))) { return false; }
+  if(response.size() > 0 && !writeFully(connection, &(response[0]), response.size())) { return false; }
+  return true;
+}
+
+//--------------------------------------------------------------------------
+
+usint
+QueryServer::process(const usint* header, const std::vector<char>& payload, std::vector<char>& response)
+{
+  if(header[1] >= this->indexes.size()) { return UNKNOWN_INDEX; }
+  if(header[2] > MAX_PAYLOAD) { return INVALID_REQUEST; }
+
+  if(header[0] == RELOAD)
+  {
+    std::string base_name(payload.begin(), payload.end());
+    return (this->reload(header[1], base_name) ? OK : LOAD_FAILED);
+  }
+
+  // The request uses the same version until it has finished.
+  Version* version = this->acquire(header[1]);
+  Request request;
+  request.type = header[0]; request.items = header[2]; request.index = version->index;
+  usint status = this->prepare(request, payload);
+  if(status == OK) { status = this->execute(request, response); }
+  this->release(version);
+  return status;
+}
+
+usint
+QueryServer::prepare(Request& request, const std::vector<char>& payload) const
+{
+  const FMD& index = *(request.index);
+  usint items = request.items;
+  request.reserved = 0;
+
+  if(request.type == DISPLAY)
+  {
+    if(!(index.supportsDisplay())) { return NOT_SUPPORTED; }
+    if(payload.size() != 3 * items * sizeof(usint)) { return INVALID_REQUEST; }
+    const usint* triples = (items > 0 ? (const usint*)&(payload[0]) : 0);
+    request.sequences.resize(items, 0);
+    request.ranges.resize(items, EMPTY_PAIR);
+    usint size = items * sizeof(usint);
+    for(usint i = 0; i < items; i++)
+    {
+      const usint* triple = triples + 3 * i;
+      if(triple[0] >= index.getNumberOfSequences()) { continue; }
+      usint last = std::min(triple[2], length(index.getSequenceRange(triple[0])) - 1);
+      request.sequences[i] = triple[0];
+      if(triple[1] <= last) { request.ranges[i] = pair_type(triple[1], last); size += length(request.ranges[i]); }
+      if(size > MAX_PAYLOAD) { return TOO_LARGE; }
+    }
+  }
+  else
+  {
+    if(!readPatterns(payload, items, request.patterns)) { return INVALID_REQUEST; }
+    if(request.type == COUNT)
+    {
+      if(2 * items * sizeof(usint) > MAX_PAYLOAD) { return TOO_LARGE; }
+    }
+    else if(request.type == LOCATE)
+    {
+      // The occurrences are reserved by each chunk after counting.
+      if(!(index.supportsLocate())) { return NOT_SUPPORTED; }
+      request.reserved = items * sizeof(usint);
+      if(request.reserved > MAX_PAYLOAD) { return TOO_LARGE; }
+    }
+    else if(request.type == MAP)
+    {
+      if(!(index.supportsLocate())) { return NOT_SUPPORTED; }
+      usint size = 0;
+      for(usint i = 0; i < items; i++) { size += 2 * request.patterns[i].length() * sizeof(usint); }
+      if(size > MAX_PAYLOAD) { return TOO_LARGE; }
+    }
+    else { return INVALID_REQUEST; }
+  }
+
+  request.chunks = (items + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  request.next = request.finished = 0;
+  request.heads.resize(request.chunks); request.data.resize(request.chunks);
+  request.status.resize(request.chunks, (usint)OK);
+  return OK;
+}
+
+usint
+QueryServer::execute(Request& request, std::vector<char>& response)
+{
+  // Offer the chunks to the other workers and process them until none are left.
+  pthread_mutex_lock(&(this->lock));
+  if(request.chunks > 1)
+  {
+    this->batches.push_back(&request);
+    pthread_cond_broadcast(&(this->wakeup));
+  }
+  while(request.next < request.chunks)
+  {
+    usint chunk = this->claimChunk(request);
+    pthread_mutex_unlock(&(this->lock));
+    this->processChunk(request, chunk);
+    pthread_mutex_lock(&(this->lock));
+    request.finished++;
+  }
+  while(request.finished < request.chunks) { pthread_cond_wait(&(this->done), &(this->lock)); }
+  pthread_mutex_unlock(&(this->lock));
+
+  usint size = 0;
+  for(usint i = 0; i < request.chunks; i++)
+  {
+    if(request.status[i] != OK) { return request.status[i]; }
+    size += request.heads[i].size() + request.data[i].size();
+  }
+  response.reserve(size);
+  for(usint i = 0; i < request.chunks; i++)
+  {
+    response.insert(response.end(), request.heads[i].begin(), request.heads[i].end());
+    std::vector<char>().swap(request.heads[i]);
+  }
+  for(usint i = 0; i < request.chunks; i++)
+  {
+    response.insert(response.end(), request.data[i].begin(), request.data[i].end());
+    std::vector<char>().swap(request.data[i]);
+  }
+  return OK;
+}
+
+usint
+QueryServer::claimChunk(Request& request)
+{
+  usint chunk = request.next; request.next++;
+  if(request.next >= request.chunks)
+  {
+    std::deque<Request*>::iterator iter = std::find(this->batches.begin(), this->batches.end(), &request);
+    if(iter != this->batches.end()) { this->batches.erase(iter); }
+  }
+  return chunk;
+}
+
+bool
+QueryServer::reserve(Request& request, usint bytes)
+{
+  pthread_mutex_lock(&(this->lock));
+  bool fits = (request.reserved + bytes <= MAX_PAYLOAD);
+  if(fits) { request.reserved += bytes; }
+  else { request.reserved = MAX_PAYLOAD + 1; }  // The remaining chunks fail as well.
+  pthread_mutex_unlock(&(this->lock));
+  return fits;
+}
+
+void
+QueryServer::processChunk(Request& request, usint chunk)
+{
+  const FMD& index = *(request.index);
+  usint first = chunk * CHUNK_SIZE, last = std::min(first + CHUNK_SIZE, request.items);
+  std::vector<char>& heads = request.heads[chunk];
+  std::vector<char>& data = request.data[chunk];
+
+  if(request.type == DISPLAY)
+  {
+    for(usint i = first; i < last; i++) { appendWord(heads, length(request.ranges[i])); }
+    for(usint i = first; i < last; i++)
+    {
+      if(isEmpty(request.ranges[i])) { continue; }
+      usint offset = data.size();
+      data.resize(offset + length(request.ranges[i]));
+      index.display(request.sequences[i], request.ranges[i], (uchar*)&(data[offset]));
+    }
+    return;
+  }
+
+  QueryContext context(index);
+  if(request.type == COUNT)
+  {
+    for(usint i = first; i < last; i++)
+    {
+      pair_type range = index.count(request.patterns[i], context);
+      appendWords(data, &(range.first), 1); appendWords(data, &(range.second), 1);
+    }
+  }
+  else if(request.type == LOCATE)
+  {
+    std::vector<pair_type> ranges(last - first);
+    usint size = 0;
+    for(usint i = first; i < last; i++)
+    {
+      ranges[i - first] = index.count(request.patterns[i], context);
+      size += length(ranges[i - first]) * sizeof(usint);
+    }
+    if(!(this->reserve(request, size))) { request.status[chunk] = TOO_LARGE; return; }
+    for(usint i = 0; i < ranges.size(); i++) { appendWord(heads, length(ranges[i])); }
+    for(usint i = 0; i < ranges.size(); i++)
+    {
+      if(isEmpty(ranges[i])) { continue; }
+      usint* occurrences = index.locate(ranges[i], context);
+      if(occurrences == 0) { request.status[chunk] = NOT_SUPPORTED; return; }
+      appendWords(data, occurrences, length(ranges[i]));
+      delete[] occurrences;
+    }
+  }
+  else if(request.type == MAP)
+  {
+    for(usint i = first; i < last; i++)
+    {
+      std::vector<Mapping> mappings = index.map(request.patterns[i]);
+      for(usint j = 0; j < mappings.size(); j++)
+      {
+        pair_type location = (mappings[j].is_mapped ? mappings[j].location : pair_type((usint)NOT_MAPPED, (usint)NOT_MAPPED));
+        appendWords(data, &(location.first), 1); appendWords(data, &(location.second), 1);
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+
+QueryClient::QueryClient(const std::string& socket_name) :
+  connection(-1)
+{
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(socket_name.length() >= sizeof(address.sun_path))
+  {
+    std::cerr << "QueryClient: Socket name " << socket_name << " is too long!" << std::endl;
+    return;
+  }
+  strncpy(address.sun_path, socket_name.c_str(), sizeof(address.sun_path) - 1);
+
+  this->connection = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(this->connection < 0) { return; }
+  if(connect(this->connection, (sockaddr*)&address, sizeof(address)) != 0)
+  {
+    std::cerr << "QueryClient: Cannot connect to " << socket_name << "!" << std::endl;
+    close(this->connection); this->connection = -1;
+  }
+}
+
+QueryClient::~QueryClient()
+{
+  if(this->connection >= 0) { close(this->connection); }
+}
+
+usint
+QueryClient::query(usint type, usint index, usint items, const std::vector<char>& request, std::vector<char>& response)
+{
+  response.clear();
+  if(!(this->isOk())) { return QueryServer::CONNECTION_ERROR; }
+
+  usint header[QueryServer::REQUEST_HEADER_WORDS] = { type, index, items, request.size() };
+  usint result[QueryServer::RESPONSE_HEADER_WORDS];
+  if(!writeFully(this->connection, (const char*)header, sizeof(header)) ||
+     (request.size() > 0 && !writeFully(this->connection, &(request[0]), request.size())) ||
+     !readFully(this->connection, (char*)result, sizeof(result)) ||
+     result[2] > QueryServer::MAX_PAYLOAD)
+  {
+    close(this->connection); this->connection = -1;
+    return QueryServer::CONNECTION_ERROR;
+  }
+
+  response.resize(result[2]);
+  if(result[2] > 0 && !readFully(this->connection, &(response[0]), result[2]))
+  {
+    close(this->connection); this->connection = -1;
+    return QueryServer::CONNECTION_ERROR;
+  }
+  return result[0];
+}
+
+usint
+QueryClient::patternQuery(usint type, usint index, const std::vector<std::string>& patterns, std::vector<char>& response)
+{
+  std::vector<char> request;
+  for(usint i = 0; i < patterns.size(); i++) { appendWord(request, patterns[i].length()); }
+  for(usint i = 0; i < patterns.size(); i++) { request.insert(request.end(), patterns[i].begin(), patterns[i].end()); }
+  return this->query(type, index, patterns.size(), request, response);
+}
+
+usint
+QueryClient::count(usint index, const std::vector<std::string>& patterns, std::vector<pair_type>& results)
+{
+  results.clear();
+  std::vector<char> response;
+  usint status = this->patternQuery(QueryServer::COUNT, index, patterns, response);
+  if(status != QueryServer::OK || response.empty()) { return status; }
+
+  const usint* words = (const usint*)&(response[0]);
+  for(usint i = 0; i < patterns.size(); i++) { results.push_back(pair_type(words[2 * i], words[2 * i + 1])); }
+  return status;
+}
+
+usint
+QueryClient::locate(usint index, const std::vector<std::string>& patterns, std::vector<std::vector<usint> >& results)
+{
+  results.clear();
+  std::vector<char> response;
+  usint status = this->patternQuery(QueryServer::LOCATE, index, patterns, response);
+  if(status != QueryServer::OK || response.empty()) { return status; }
+
+  const usint* words = (const usint*)&(response[0]);
+  const usint* occurrences = words + patterns.size();
+  for(usint i = 0; i < patterns.size(); i++)
+  {
+    results.push_back(std::vector<usint>(occurrences, occurrences + words[i]));
+    occurrences += words[i];
+  }
+  return status;
+}
+
+usint
+QueryClient::display(usint index, const std::vector<display_type>& ranges, std::vector<std::string>& results)
+{
+  results.clear();
+  std::vector<char> request, response;
+  for(usint i = 0; i < ranges.size(); i++)
+  {
+    usint triple[3] = { ranges[i].first, ranges[i].second.first, ranges[i].second.second };
+    appendWords(request, triple, 3);
+  }
+  usint status = this->query(QueryServer::DISPLAY, index, ranges.size(), request, response);
+  if(status != QueryServer::OK || response.empty()) { return status; }
+
+  const usint* lengths = (const usint*)&(response[0]);
+  usint offset = ranges.size() * sizeof(usint);
+  for(usint i = 0; i < ranges.size(); i++)
+  {
+    results.push_back(std::string(&(response[0]) + offset, lengths[i]));
+    offset += lengths[i];
+  }
+  return status;
+}
+
+usint
+QueryClient::map(usint index, const std::vector<std::string>& patterns, std::vector<std::vector<pair_type> >& results)
+{
+  results.clear();
+  std::vector<char> response;
+  usint status = this->patternQuery(QueryServer::MAP, index, patterns, response);
+  if(status != QueryServer::OK || response.empty()) { return status; }
+
+  const pair_type* locations = (const pair_type*)&(response[0]);
+  for(usint i = 0; i < patterns.size(); i++)
+  {
+    results.push_back(std::vector<pair_type>(locations, locations + patterns[i].length()));
+    locations += patterns[i].length();
+  }
+  return status;
+}
+
+usint
+QueryClient::reload(usint index, const std::string& base_name)
+{
+  std::vector<char> request(base_name.begin(), base_name.end()), response;
+  return this->query(QueryServer::RELOAD, index, 0, request, response);
+}
+
+
+} // namespace CSA
@@ -0,0 +1,223 @@
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <pthread.h>
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "fmd.h"
+
+
+namespace CSA
+{
+
+
+/*
+  A query server loads the indexes once and answers batched queries over a Unix domain
+  socket. A client can send any number of requests over the same connection. The
+  server polls the idle connections and queues each request to a pool of worker
+  threads, so idle clients do not hold a worker. A worker answering a batch of more
+  than CHUNK_SIZE items splits it into chunks, and the idle workers help with them.
+  A connection is closed if a request or a response stalls for IO_TIMEOUT seconds.
+
+  All integers in the protocol are usints in the byte order of the machine. A request
+  is a header (type, index, items, payload bytes) followed by the payload:
+
+    COUNT, LOCATE, MAP  lengths of the items patterns, followed by the patterns
+    DISPLAY             items triples (sequence, first, last)
+    RELOAD              a new base name for the index, or nothing for the current one
+
+  The index is the position of the index on the command line of the server. A response
+  is a header (status, items, payload bytes) followed by the payload:
+
+    COUNT    items SA ranges (sp, ep); empty ranges are (1, 0)
+    LOCATE   items occurrence counts, followed by the occurrences
+    DISPLAY  items lengths, followed by the substrings of the sequences
+    MAP      a pair (text, position) for each base of each pattern; unmapped
+             bases are (NOT_MAPPED, NOT_MAPPED)
+    RELOAD   nothing
+
+  Display ranges are positions in the sequence, and they are clipped to the sequence.
+  If the status is not OK, the response has no payload. If the payload would be larger
+  than MAX_PAYLOAD, the status is TOO_LARGE, and the batch should be split.
+
+  RELOAD loads a new version of the index and swaps it in after it has been prefetched.
+  The other queries are served from the old version during the load. Each request holds
+  a reference to the version it started with, and the old version is deleted when the
+  last request using it has finished. The response is sent after the swap. The files of
+  the served versions are memory mapped. RLCSA::writeTo() and ContainerWriter replace
+  the files by renaming, so a new version can be written over the old base name. The
+  served version keeps using the old files until it is released.
+*/
+
+class QueryServer
+{
+  public:
+    const static usint COUNT = 1;
+    const static usint LOCATE = 2;
+    const static usint DISPLAY = 3;
+    const static usint MAP = 4;
+    const static usint RELOAD = 5;
+
+    const static usint OK = 0;
+    const static usint INVALID_REQUEST = 1;
+    const static usint UNKNOWN_INDEX = 2;
+    const static usint NOT_SUPPORTED = 3;
+    const static usint CONNECTION_ERROR = 4;  // Only returned by the client.
+    const static usint LOAD_FAILED = 5;
+    const static usint TOO_LARGE = 6;
+
+    const static usint REQUEST_HEADER_WORDS = 4;
+    const static usint RESPONSE_HEADER_WORDS = 3;
+    const static usint MAX_PAYLOAD = (usint)1 << 30;
+    const static usint NOT_MAPPED = ~((usint)0);
+    const static usint CHUNK_SIZE = 1024;  // Items.
+    const static usint IO_TIMEOUT = 30;    // Seconds.
+
+    // Loads the indexes with memory mapping and prefetches them.
+    QueryServer(const std::vector<std::string>& base_names, usint threads);
+    ~QueryServer();
+
+    inline bool isOk() const { return this->ok; }
+    inline usint getNumberOfIndexes() const { return this->indexes.size(); }
+
+    // Loads a new version of the index and swaps it in. An empty base name reloads the
+    // current base name. Returns false if the index cannot be loaded.
+    bool reload(usint index, const std::string& base_name = "");
+    std::string getBaseName(usint index);
+
+    // Serves queries until stop() is called. Returns false if the socket cannot be created.
+    bool serve(const std::string& socket_name);
+
+    // Only set a flag, so they can be called from a signal handler. The indexes are
+    // reloaded in a background thread started by serve().
+    void stop();
+    void reloadAll();
+
+  private:
+    // A version of an index. The current version holds one reference.
+    struct Version
+    {
+      FMD*        index;
+      std::string base_name;
+      usint       references;
+    };
+
+    // A batch being answered. Its items are split into chunks of CHUNK_SIZE items.
+    // The item headers of each chunk are followed by its data in the response.
+    struct Request
+    {
+      usint      type, items;
+      const FMD* index;
+
+      std::vector<std::string> patterns;   // COUNT, LOCATE, MAP
+      std::vector<usint>       sequences;  // DISPLAY
+      std::vector<pair_type>   ranges;     // DISPLAY
+
+      std::vector<std::vector<char> > heads, data;
+      std::vector<usint>               status;
+
+      // Protected by the lock of the server.
+      usint chunks, next, finished, reserved;
+    };
+
+    std::vector<Version*>  indexes;
+    std::vector<pthread_t> workers;
+    usint                  threads;
+
+    // Protects the current versions and the reference counts. Reloads are serialized.
+    pthread_mutex_t version_lock;
+    pthread_mutex_t reload_lock;
+    pthread_t       reloader;
+    bool            reloader_started;
+
+    // Connections with a request waiting for a worker, connections being served, and
+    // connections the workers have returned to the poll set. Batches with chunks left.
+    // A byte written to notify wakes up the polling thread.
+    std::deque<int>       pending;
+    std::set<int>         active;
+    std::deque<int>       returned;
+    std::deque<Request*>  batches;
+    pthread_mutex_t       lock;
+    pthread_cond_t        wakeup, done;
+    int                   notify[2];
+
+    volatile bool stopping;
+    volatile bool reload_requested;
+    volatile bool reloading;
+    bool          ok;
+
+    static void* workerMain(void* server);
+    static void* reloaderMain(void* server);
+    void work();
+
+    // Answers one request. Returns false if the connection should be closed.
+    bool serveRequest(int connection);
+    usint process(const usint* header, const std::vector<char>& payload, std::vector<char>& response);
+
+    // Parses the request and checks the size of the response.
+    usint prepare(Request& request, const std::vector<char>& payload) const;
+    usint execute(Request& request, std::vector<char>& response);
+    void processChunk(Request& request, usint chunk);
+
+    // Must be called with the lock held.
+    usint claimChunk(Request& request);
+
+    // Reserves space in the response. Returns false if it would exceed MAX_PAYLOAD.
+    bool reserve(Request& request, usint bytes);
+
+    FMD* load(const std::string& base_name) const;
+    Version* acquire(usint index);
+    void release(Version* version);
+
+    // These are not allowed.
+    QueryServer();
+    QueryServer(const QueryServer&);
+    QueryServer& operator = (const QueryServer&);
+};
+
+
+//--------------------------------------------------------------------------
+
+
+/*
+  A client for QueryServer. The queries return the status of the response. Each
+  result vector contains one item for each item in the query.
+*/
+
+class QueryClient
+{
+  public:
+    typedef std::pair<usint, pair_type> display_type;  // (sequence, range)
+
+    explicit QueryClient(const std::string& socket_name);
+    ~QueryClient();
+
+    inline bool isOk() const { return (this->connection >= 0); }
+
+    usint count(usint index, const std::vector<std::string>& patterns, std::vector<pair_type>& results);
+    usint locate(usint index, const std::vector<std::string>& patterns, std::vector<std::vector<usint> >& results);
+    usint display(usint index, const std::vector<display_type>& ranges, std::vector<std::string>& results);
+    usint map(usint index, const std::vector<std::string>& patterns, std::vector<std::vector<pair_type> >& results);
+    usint reload(usint index, const std::string& base_name = "");
+
+  private:
+    int connection;
+
+    // Sends the request and receives the response payload.
+    usint query(usint type, usint index, usint items, const std::vector<char>& request, std::vector<char>& response);
+    usint patternQuery(usint type, usint index, const std::vector<std::string>& patterns, std::vector<char>& response);
+
+    // These are not allowed.
+    QueryClient();
+    QueryClient(const QueryClient&);
+    QueryClient& operator = (const QueryClient&);
+};
+
+
+} // namespace CSA
+
+
+#endif // QUERYSERVER_H
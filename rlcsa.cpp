@@ -1,10 +1,13 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <fstream>
 #include <iostream>
 #include <list>
+#include <sstream>
 
+#include "container.h"
 #include "rlcsa.h"
 #include "misc/utils.h"
 #include "bits/vectors.h"
@@ -18,54 +21,217 @@ namespace CSA
 {
 
 
-RLCSA::RLCSA(const std::string& base_name, bool print) :
+// Returns the format version of an index file and skips the header.
+usint
+readFormatVersion(std::ifstream& file)
+{
+  usint header = 0, version = 0;
+  std::streampos start = file.tellg();  // The file may be a section of a container.
+  file.read((char*)&header, sizeof(header));
+  if(file && header == INDEX_FILE_MAGIC) { file.read((char*)&version, sizeof(version)); }
+  else { file.clear(); file.seekg(start); }
+  return version;
+}
+
+usint
+readFormatVersion(FileMap& file)
+{
+  if(file.getSize() >= 2 && file.readWord() == INDEX_FILE_MAGIC) { return file.readWord(); }
+  file.seek(0);
+  return 0;
+}
+
+void
+writeFormatVersion(std::ofstream& file)
+{
+  usint header[2] = { INDEX_FILE_MAGIC, INDEX_FILE_VERSION };
+  file.write((char*)header, sizeof(header));
+}
+
+// Indexes without the encoding parameters use the compiled-in default encodings.
+usint
+readPsiEncoding(const Parameters& parameters)
+{
+  if(parameters.contains(PSI_ENCODING.first)) { return parameters.get(PSI_ENCODING); }
+  usint encoding = PsiVector::getDefaultEncoding();
+  return (encoding == PsiVector::AUTOMATIC ? (usint)PsiVector::RLE : encoding);
+}
+
+usint
+readSAEncoding(const Parameters& parameters)
+{
+  if(parameters.contains(SA_ENCODING.first)) { return parameters.get(SA_ENCODING); }
+  return SAVector::getDefaultEncoding();
+}
+
+// The files are written under a temporary name and renamed over the old files, so
+// that a memory mapped version of the old index remains valid.
+bool
+replaceFile(const std::string& file_name, bool written)
+{
+  std::string temp_name = file_name + ContainerWriter::TEMP_EXTENSION;
+  if(!written || std::rename(temp_name.c_str(), file_name.c_str()) != 0)
+  {
+    std::cerr << "RLCSA: Error writing " << file_name << "!" << std::endl;
+    std::remove(temp_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------
+
+RLCSA::RLCSA(const std::string& base_name, bool print, bool memory_map, usint threads) :
   ok(false),
   alphabet(0),
   sa_samples(0), support_locate(false), support_display(false),
-  end_points(0)
+  end_points(0), kmer_table(0), run_samples(0),
+  locate_run_length(LOCATE_RUN_LENGTH.second),
+  array_map(0), sample_map(0)
 {
   for(usint c = 0; c < CHARS; c++) { this->array[c] = 0; }
+  this->initializeLazyLoading();
 
-  std::string array_name = base_name + ARRAY_EXTENSION;
-  std::ifstream array_file(array_name.c_str(), std::ios_base::binary);
-  if(!array_file)
+  Parameters parameters;
+  if(!readIndexParameters(base_name, parameters))
+  {
+    std::cerr << "RLCSA: Cannot read the parameters of " << base_name << "!" << std::endl;
+  }
+  usint psi_encoding = readPsiEncoding(parameters);
+  this->setLocateRunLength(parameters.get(LOCATE_RUN_LENGTH));
+  if(!PsiVector::isValidEncoding(psi_encoding) && psi_encoding != PsiVector::MIXED)
   {
-    std::cerr << "RLCSA: Error opening Psi array file!" << std::endl;
+    std::cerr << "RLCSA: Unknown Psi encoding " << psi_encoding << "!" << std::endl;
     return;
   }
 
-  usint distribution[CHARS];
-  array_file.read((char*)distribution, CHARS * sizeof(usint));
-  this->alphabet = new Alphabet(distribution); this->data_size = this->alphabet->getDataSize();
-
-  Parameters parameters;
-  parameters.read(base_name + PARAMETERS_EXTENSION);
-  for(usint c = 0; c < CHARS; c++)
+  if(memory_map)
   {
-    if(this->alphabet->hasChar(c)) { this->array[c] = new PsiVector(array_file); }
+    this->array_map = mapIndexFile(base_name, ARRAY_EXTENSION);
+    if(this->array_map == 0 || !(this->array_map->isOk()))
+    {
+      std::cerr << "RLCSA: Error mapping Psi array file!" << std::endl;
+      return;
+    }
+    usint version = readFormatVersion(*(this->array_map));
+    if(version > INDEX_FILE_VERSION)
+    {
+      std::cerr << "RLCSA: Unsupported Psi array file version " << version << "!" << std::endl;
+      return;
+    }
+
+    const usint* distribution = this->array_map->readWords(CHARS);
+    if(distribution == 0)
+    {
+      std::cerr << "RLCSA: Psi array file is truncated!" << std::endl;
+      return;
+    }
+    this->alphabet = new Alphabet(distribution); this->data_size = this->alphabet->getDataSize();
+    if(version >= 2) { this->array_map->readWords(ARRAY_TABLE_WORDS); }
+    for(usint c = 0; c < CHARS && this->array_map->isOk(); c++)
+    {
+      if(!(this->alphabet->hasChar(c))) { continue; }
+      usint encoding = (psi_encoding == PsiVector::MIXED ? this->array_map->readWord() : psi_encoding);
+      this->array[c] = new PsiVector(*(this->array_map), encoding, version >= 1);
+    }
+
+    if(this->array_map->isOk())
+    {
+      this->end_points = new DeltaVector(*(this->array_map), version >= 1);
+      this->number_of_sequences = this->end_points->getNumberOfItems();
+      this->sample_rate = this->array_map->readWord();
+    }
+    if(!(this->array_map->isOk()))
+    {
+      std::cerr << "RLCSA: Psi array file is truncated!" << std::endl;
+      return;
+    }
   }
+  else
+  {
+    std::ifstream array_file;
+    if(!openIndexFile(base_name, ARRAY_EXTENSION, array_file))
+    {
+      std::cerr << "RLCSA: Error opening Psi array file!" << std::endl;
+      return;
+    }
+    std::streampos array_start = array_file.tellg();
+    usint version = readFormatVersion(array_file);
+    if(version > INDEX_FILE_VERSION)
+    {
+      std::cerr << "RLCSA: Unsupported Psi array file version " << version << "!" << std::endl;
+      return;
+    }
 
-  this->end_points = new DeltaVector(array_file);
-  this->number_of_sequences = this->end_points->getNumberOfItems();
+    usint distribution[CHARS];
+    array_file.read((char*)distribution, CHARS * sizeof(usint));
+    this->alphabet = new Alphabet(distribution); this->data_size = this->alphabet->getDataSize();
+    if(version >= 2)
+    {
+      usint table[ARRAY_TABLE_WORDS];
+      array_file.read((char*)table, sizeof(table));
+      array_file.close();
+      if(!array_file)
+      {
+        std::cerr << "RLCSA: Psi array file is truncated!" << std::endl;
+        return;
+      }
+      this->sample_rate = table[0];
+      if(!(this->loadParallel(base_name, parameters, array_start, table + 1, threads))) { return; }
+    }
+    else
+    {
+      for(usint c = 0; c < CHARS; c++)
+      {
+        if(!(this->alphabet->hasChar(c))) { continue; }
+        usint encoding = psi_encoding;
+        if(psi_encoding == PsiVector::MIXED) { array_file.read((char*)&encoding, sizeof(encoding)); }
+        this->array[c] = new PsiVector(array_file, encoding, version >= 1);
+      }
 
-  array_file.read((char*)&(this->sample_rate), sizeof(this->sample_rate));
-  array_file.close();
+      this->end_points = new DeltaVector(array_file, version >= 1);
+      array_file.read((char*)&(this->sample_rate), sizeof(this->sample_rate));
+      array_file.close();
+    }
+    this->number_of_sequences = this->end_points->getNumberOfItems();
+  }
 
   if(parameters.get(SUPPORT_LOCATE) || parameters.get(SUPPORT_DISPLAY))
   {
-    std::string sa_sample_name = base_name + SA_SAMPLES_EXTENSION;
-    std::ifstream sa_sample_file(sa_sample_name.c_str(), std::ios_base::binary);
-    if(!sa_sample_file)
+    // Check that the samples exist. They are loaded when they are first used.
+    std::ifstream sa_sample_file;
+    if(!openIndexFile(base_name, SA_SAMPLES_EXTENSION, sa_sample_file))
     {
       std::cerr << "RLCSA: Error opening suffix array sample file!" << std::endl;
       return;
     }
-    bool weighted = parameters.get(WEIGHTED_SAMPLES);
-    this->sa_samples = new SASamples(sa_sample_file, this->sample_rate, weighted);
+    usint version = readFormatVersion(sa_sample_file);
     sa_sample_file.close();
+    if(version > INDEX_FILE_VERSION)
+    {
+      std::cerr << "RLCSA: Unsupported suffix array sample file version " << version << "!" << std::endl;
+      return;
+    }
+    this->samples_name = base_name;
+    this->samples_parameters = parameters;
+    this->samples_mapped = memory_map;
+    this->samples_pending = true;
+    this->support_locate = parameters.get(SUPPORT_LOCATE);
+    this->support_display = parameters.get(SUPPORT_DISPLAY);
+  }
 
-    this->support_locate = this->sa_samples->supportsLocate();
-    this->support_display = this->sa_samples->supportsDisplay();
+  std::ifstream run_sample_file;
+  if(openIndexFile(base_name, RUN_SAMPLES_EXTENSION, run_sample_file))
+  {
+    this->setRunSamples(new RunSamples(run_sample_file, *this));
+    run_sample_file.close();
+  }
+
+  std::ifstream kmer_table_file;
+  if(openIndexFile(base_name, KMER_TABLE_EXTENSION, kmer_table_file))
+  {
+    kmer_table_file.close();
+    this->setKmerTable(new KmerTable(base_name, *this));
   }
 
   if(print) { parameters.print(); }
@@ -73,13 +239,159 @@ RLCSA::RLCSA(const std::string& base_name, bool print) :
   this->ok = true;
 }
 
+bool
+RLCSA::loadSASamples(const std::string& base_name, const Parameters& parameters, bool memory_map)
+{
+  bool weighted = parameters.get(WEIGHTED_SAMPLES);
+  if(memory_map)
+  {
+    this->sample_map = mapIndexFile(base_name, SA_SAMPLES_EXTENSION);
+    if(this->sample_map == 0 || !(this->sample_map->isOk()))
+    {
+      std::cerr << "RLCSA: Error mapping suffix array sample file!" << std::endl;
+      return false;
+    }
+    usint version = readFormatVersion(*(this->sample_map));
+    if(version > INDEX_FILE_VERSION)
+    {
+      std::cerr << "RLCSA: Unsupported suffix array sample file version " << version << "!" << std::endl;
+      return false;
+    }
+    this->sa_samples = new SASamples(*(this->sample_map), this->sample_rate, weighted, readSAEncoding(parameters), version >= 1);
+    if(!(this->sample_map->isOk()))
+    {
+      std::cerr << "RLCSA: Suffix array sample file is truncated!" << std::endl;
+      return false;
+    }
+  }
+  else
+  {
+    std::ifstream sa_sample_file;
+    if(!openIndexFile(base_name, SA_SAMPLES_EXTENSION, sa_sample_file))
+    {
+      std::cerr << "RLCSA: Error opening suffix array sample file!" << std::endl;
+      return false;
+    }
+    usint version = readFormatVersion(sa_sample_file);
+    if(version > INDEX_FILE_VERSION)
+    {
+      std::cerr << "RLCSA: Unsupported suffix array sample file version " << version << "!" << std::endl;
+      return false;
+    }
+    this->sa_samples = new SASamples(sa_sample_file, this->sample_rate, weighted, readSAEncoding(parameters), version >= 1);
+    if(!sa_sample_file)
+    {
+      std::cerr << "RLCSA: Suffix array sample file is truncated!" << std::endl;
+      return false;
+    }
+    sa_sample_file.close();
+  }
+
+  return true;
+}
+
+void
+RLCSA::initializeLazyLoading()
+{
+  this->samples_pending = false;
+  this->samples_mapped = false;
+  #ifdef MULTITHREAD_SUPPORT
+  omp_init_lock(&(this->samples_lock));
+  #endif
+}
+
+void
+RLCSA::loadPendingSamples() const
+{
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_lock(&(this->samples_lock));
+  #endif
+  if(this->samples_pending)
+  {
+    // Loading only initializes the samples, so a const index can do it.
+    RLCSA* index = const_cast<RLCSA*>(this);
+    if(!(index->loadSASamples(this->samples_name, this->samples_parameters, this->samples_mapped)))
+    {
+      // The index no longer supports locate or display.
+      std::cerr << "RLCSA: Error loading the suffix array samples of " << this->samples_name << "!" << std::endl;
+      delete index->sa_samples; index->sa_samples = 0;
+      delete index->sample_map; index->sample_map = 0;
+      index->support_locate = false; index->support_display = false;
+    }
+    __atomic_store_n(&(this->samples_pending), false, __ATOMIC_RELEASE);
+  }
+  #ifdef MULTITHREAD_SUPPORT
+  omp_unset_lock(&(this->samples_lock));
+  #endif
+}
+
+void
+RLCSA::prefetch() const
+{
+  this->getSASamples();
+  if(this->array_map != 0) { this->array_map->prefetch(); }
+  if(this->sample_map != 0) { this->sample_map->prefetch(); }
+}
+
+bool
+RLCSA::loadParallel(const std::string& base_name, const Parameters& parameters, std::streampos array_start, const usint* offsets, usint threads)
+{
+  // Tasks are characters and END_POINT_TASK. The largest are started first.
+  const usint END_POINT_TASK = CHARS;
+  std::vector<pair_type> tasks;  // (size, task)
+  usint next = offsets[CHARS];
+  for(usint c = CHARS; c > 0; c--)
+  {
+    if(!(this->alphabet->hasChar(c - 1))) { continue; }
+    tasks.push_back(pair_type(next - offsets[c - 1], c - 1));
+    next = offsets[c - 1];
+  }
+  tasks.push_back(pair_type(0, END_POINT_TASK));
+  std::stable_sort(tasks.begin(), tasks.end(), std::greater<pair_type>());
+
+  usint psi_encoding = readPsiEncoding(parameters);
+  bool should_be_ok = true;
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #endif
+  #pragma omp parallel for schedule(dynamic, 1)
+  for(sint i = 0; i < (sint)(tasks.size()); i++)
+  {
+    usint task = tasks[i].second;
+
+    // Each task reads its part of the file with a separate stream.
+    std::ifstream array_file;
+    openIndexFile(base_name, ARRAY_EXTENSION, array_file);
+    array_file.seekg(array_start + (std::streamoff)(offsets[task]));
+    if(task == END_POINT_TASK) { this->end_points = new DeltaVector(array_file, true); }
+    else
+    {
+      usint encoding = psi_encoding;
+      if(psi_encoding == PsiVector::MIXED) { array_file.read((char*)&encoding, sizeof(encoding)); }
+      this->array[task] = new PsiVector(array_file, encoding, true);
+    }
+    if(!array_file) { should_be_ok = false; }
+    array_file.close();
+  }
+
+  if(!should_be_ok)
+  {
+    std::cerr << "RLCSA: Error loading the index in parallel!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
 RLCSA::RLCSA(uchar* data, usint bytes, usint block_size, usint sa_sample_rate, usint threads, bool delete_data) :
   ok(false),
   alphabet(0),
   sa_samples(0), support_locate(false), support_display(false),
-  sample_rate(sa_sample_rate), end_points(0)
+  sample_rate(sa_sample_rate), end_points(0), kmer_table(0), run_samples(0),
+  locate_run_length(LOCATE_RUN_LENGTH.second),
+  array_map(0), sample_map(0)
 {
   for(usint c = 0; c < CHARS; c++) { this->array[c] = 0; }
+  this->initializeLazyLoading();
  
   if(!data || bytes == 0)
   {
@@ -100,9 +412,12 @@ RLCSA::RLCSA(uchar* data, usint bytes, usint block_size, usint sa_sample_rate, u
 RLCSA::RLCSA(uchar* data, usint* ranks, usint bytes, usint block_size, usint sa_sample_rate, usint threads, bool delete_data) :
   ok(false),
   sa_samples(0), support_locate(false), support_display(false),
-  sample_rate(sa_sample_rate), end_points(0)
+  sample_rate(sa_sample_rate), end_points(0), kmer_table(0), run_samples(0),
+  locate_run_length(LOCATE_RUN_LENGTH.second),
+  array_map(0), sample_map(0)
 {
   for(usint c = 0; c < CHARS; c++) { this->array[c] = 0; }
+  this->initializeLazyLoading();
  
   if(!data || !ranks || bytes == 0)
   {
@@ -125,9 +440,12 @@ RLCSA::RLCSA(uchar* data, usint bytes, usint block_size, usint sa_sample_rate, u
   alphabet(0),
   sa_samples(0), support_locate(false), support_display(false),
   sample_rate(sa_sample_rate),
-  end_points(0)
+  end_points(0), kmer_table(0), run_samples(0),
+  locate_run_length(LOCATE_RUN_LENGTH.second),
+  array_map(0), sample_map(0)
 {
   for(usint c = 0; c < CHARS; c++) { this->array[c] = 0; }
+  this->initializeLazyLoading();
 
   if(!data || bytes == 0)
   {
@@ -155,9 +473,12 @@ RLCSA::RLCSA(RLCSA& index, RLCSA& increment, usint* positions, usint block_size,
   ok(false),
   alphabet(0),
   sa_samples(0), support_locate(false), support_display(false),
-  end_points(0)
+  end_points(0), kmer_table(0), run_samples(0),
+  locate_run_length(LOCATE_RUN_LENGTH.second),
+  array_map(0), sample_map(0)
 {
   for(usint c = 0; c < CHARS; c++) { this->array[c] = 0; }
+  this->initializeLazyLoading();
 
   if(!index.isOk() || !increment.isOk())
   {
@@ -225,76 +546,328 @@ RLCSA::~RLCSA()
   delete this->alphabet; this->alphabet = 0;
   delete this->sa_samples; this->sa_samples = 0;
   delete this->end_points; this->end_points = 0;
+  delete this->kmer_table; this->kmer_table = 0;
+  delete this->run_samples; this->run_samples = 0;
+  delete this->array_map; this->array_map = 0;
+  delete this->sample_map; this->sample_map = 0;
+  #ifdef MULTITHREAD_SUPPORT
+  omp_destroy_lock(&(this->samples_lock));
+  #endif
+}
+
+void
+RLCSA::setKmerTable(KmerTable* table)
+{
+  delete this->kmer_table; this->kmer_table = 0;
+  if(table == 0) { return; }
+  if(!(table->isOk()))
+  {
+    delete table;
+    return;
+  }
+  this->kmer_table = table;
+}
+
+void
+RLCSA::setSASamples(SASamples* samples)
+{
+  delete this->sa_samples; this->sa_samples = samples;
+  delete this->sample_map; this->sample_map = 0;
+  this->samples_pending = false;
+  this->support_locate = (samples != 0 && samples->supportsLocate());
+  this->support_display = (samples != 0 && samples->supportsDisplay());
+}
+
+void
+RLCSA::setRunSamples(RunSamples* samples)
+{
+  delete this->run_samples; this->run_samples = 0;
+  if(samples == 0) { return; }
+  if(!(samples->isOk()))
+  {
+    delete samples;
+    return;
+  }
+  this->run_samples = samples;
+}
+
+bool
+RLCSA::buildSASamples(usint sample_rate, usint threads)
+{
+  if(!(this->ok) || sample_rate == 0) { return false; }
+  threads = std::max(threads, (usint)1);
+
+  // Pad the sequences again if the sample rate changes.
+  usint sequences = this->number_of_sequences;
+  std::vector<pair_type> ranges(sequences);
+  for(usint i = 0; i < sequences; i++) { ranges[i] = this->getSequenceRange(i); }
+  if(sample_rate != this->sample_rate)
+  {
+    DeltaEncoder endings(RLCSA::ENDPOINT_BLOCK_SIZE);
+    usint start = 0;
+    for(usint i = 0; i < sequences; i++)
+    {
+      ranges[i] = pair_type(start, start + length(ranges[i]) - 1);
+      endings.setBit(ranges[i].second);
+      start = nextMultipleOf(sample_rate, ranges[i].second);
+    }
+    delete this->end_points; this->end_points = new DeltaVector(endings, start);
+    this->setRunSamples(0);
+  }
+  this->sample_rate = sample_rate;
+
+  // Sample offsets 0, sample_rate, 2 * sample_rate, ... of each sequence.
+  std::vector<usint> first_sample(sequences + 1, 0);
+  for(usint i = 0; i < sequences; i++)
+  {
+    first_sample[i + 1] = first_sample[i] + (length(ranges[i]) + sample_rate - 1) / sample_rate;
+  }
+  std::vector<pair_type> samples(first_sample[sequences]);
+
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #pragma omp parallel
+  #endif
+  {
+    QueryContext context(*this);
+    std::vector<usint> offsets;
+    #ifdef MULTITHREAD_SUPPORT
+    #pragma omp for schedule(dynamic, 1)
+    #endif
+    for(sint i = 0; i < (sint)sequences; i++)
+    {
+      offsets.clear();
+      for(usint offset = 0; offset < length(ranges[i]); offset += sample_rate) { offsets.push_back(offset); }
+      this->sampleSequence(i, &(offsets[0]), offsets.size(), &(samples[first_sample[i]]), context);
+    }
+  }
+
+  // The size is the same as in construction.
+  this->setSASamples(new SASamples(samples, this->getTextSize() + 1, sample_rate, threads));
+  return true;
+}
+
+bool
+RLCSA::buildSASamples(std::vector<usint>& positions, usint threads)
+{
+  if(!(this->ok)) { return false; }
+  threads = std::max(threads, (usint)1);
+
+  usint sequences = this->number_of_sequences;
+  std::vector<pair_type> ranges(sequences);
+  for(usint i = 0; i < sequences; i++)
+  {
+    ranges[i] = this->getSequenceRange(i);
+    positions.push_back(ranges[i].first);
+  }
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #endif
+  parallelSort(positions.begin(), positions.end());
+  positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+  // Convert the positions to offsets within the sequences.
+  std::vector<usint> offsets, first_sample(sequences + 1, 0);
+  std::vector<usint>::iterator iter = positions.begin();
+  for(usint i = 0; i < sequences; i++)
+  {
+    while(iter != positions.end() && *iter < ranges[i].first) { ++iter; }
+    for(; iter != positions.end() && *iter <= ranges[i].second; ++iter) { offsets.push_back(*iter - ranges[i].first); }
+    first_sample[i + 1] = offsets.size();
+  }
+  positions.clear();
+  std::vector<pair_type> samples(offsets.size());
+
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #pragma omp parallel
+  #endif
+  {
+    QueryContext context(*this);
+    #ifdef MULTITHREAD_SUPPORT
+    #pragma omp for schedule(dynamic, 1)
+    #endif
+    for(sint i = 0; i < (sint)sequences; i++)
+    {
+      this->sampleSequence(i, &(offsets[first_sample[i]]), first_sample[i + 1] - first_sample[i],
+        &(samples[first_sample[i]]), context);
+    }
+  }
+
+  this->setSASamples(new SASamples(samples, this->getTextSize(), threads));
+  return true;
 }
 
 //--------------------------------------------------------------------------
 
 void
-RLCSA::writeTo(const std::string& base_name) const
+RLCSA::writeTo(const std::string& base_name, bool container) const
 {
+  if(container)
+  {
+    ContainerWriter writer(base_name + CONTAINER_EXTENSION);
+    std::ostringstream parameter_stream;
+    this->getParameters().write(parameter_stream);
+    writer.addSection(PARAMETERS_EXTENSION) << parameter_stream.str();
+    this->writeArrayTo(writer.addSection(ARRAY_EXTENSION));
+    if(this->getSASamples() != 0) { this->writeSASamplesTo(writer.addSection(SA_SAMPLES_EXTENSION)); }
+    if(this->run_samples != 0) { this->run_samples->writeTo(writer.addSection(RUN_SAMPLES_EXTENSION)); }
+    if(!(writer.close()))
+    {
+      std::cerr << "RLCSA: Error writing index container!" << std::endl;
+    }
+    return;
+  }
+
   std::string array_name = base_name + ARRAY_EXTENSION;
-  std::ofstream array_file(array_name.c_str(), std::ios_base::binary);
+  std::ofstream array_file((array_name + ContainerWriter::TEMP_EXTENSION).c_str(), std::ios_base::binary);
   if(!array_file)
   {
     std::cerr << "RLCSA: Error creating Psi array file!" << std::endl;
     return;
   }
+  this->writeArrayTo(array_file);
+  array_file.close();
+  if(!replaceFile(array_name, !array_file.fail())) { return; }
+
+  this->writeSamplesTo(base_name);
+}
 
+void
+RLCSA::writeArrayTo(std::ofstream& array_file) const
+{
+  usint psi_encoding = this->getPsiEncoding();
+  std::streampos array_start = array_file.tellp();
+  writeFormatVersion(array_file);
   this->alphabet->writeTo(array_file);
+
+  // The table is written again when the offsets are known.
+  std::streampos table_start = array_file.tellp();
+  usint table[ARRAY_TABLE_WORDS];
+  for(usint i = 0; i < ARRAY_TABLE_WORDS; i++) { table[i] = 0; }
+  table[0] = this->sample_rate;
+  array_file.write((char*)table, sizeof(table));
+
   for(usint c = 0; c < CHARS; c++)
   {
     if(this->array[c] != 0)
     {
+      table[c + 1] = array_file.tellp() - array_start;
+      if(psi_encoding == PsiVector::MIXED)
+      {
+        usint encoding = this->array[c]->getEncoding();
+        array_file.write((char*)&encoding, sizeof(encoding));
+      }
       this->array[c]->writeTo(array_file);
+      this->array[c]->writeIndexesTo(array_file);
     }
   }
 
+  table[CHARS + 1] = array_file.tellp() - array_start;
   this->end_points->writeTo(array_file);
+  this->end_points->writeIndexesTo(array_file);
   array_file.write((char*)&(this->sample_rate), sizeof(this->sample_rate));
-  array_file.close();
 
-  if(this->sa_samples != 0)
+  std::streampos array_end = array_file.tellp();
+  array_file.seekp(table_start);
+  array_file.write((char*)table, sizeof(table));
+  array_file.seekp(array_end);
+}
+
+void
+RLCSA::writeSamplesTo(const std::string& base_name) const
+{
+  if(this->getSASamples() != 0)
   {
     std::string sa_sample_name = base_name + SA_SAMPLES_EXTENSION;
-    std::ofstream sa_sample_file(sa_sample_name.c_str(), std::ios_base::binary);
+    std::ofstream sa_sample_file((sa_sample_name + ContainerWriter::TEMP_EXTENSION).c_str(), std::ios_base::binary);
     if(!sa_sample_file)
     {
       std::cerr << "RLCSA: Error creating suffix array sample file!" << std::endl;
       return;
     }
-
-    this->sa_samples->writeTo(sa_sample_file);
+    this->writeSASamplesTo(sa_sample_file);
     sa_sample_file.close();
+    if(!replaceFile(sa_sample_name, !sa_sample_file.fail())) { return; }
   }
 
+  std::string parameter_name = base_name + PARAMETERS_EXTENSION;
+  this->getParameters().write(parameter_name + ContainerWriter::TEMP_EXTENSION);
+  replaceFile(parameter_name, true);
+}
+
+void
+RLCSA::writeSASamplesTo(std::ofstream& sa_sample_file) const
+{
+  // Weighted samples are stored as sample pairs without a header.
+  bool store_indexes = !(this->getSASamples()->isWeighted());
+  if(store_indexes) { writeFormatVersion(sa_sample_file); }
+  this->getSASamples()->writeTo(sa_sample_file, store_indexes);
+}
+
+Parameters
+RLCSA::getParameters() const
+{
+  usint psi_encoding = this->getPsiEncoding();
   Parameters parameters;
   parameters.set(RLCSA_BLOCK_SIZE.first, this->getBlockSize() * sizeof(usint));
   parameters.set(SAMPLE_RATE.first, this->sample_rate);
   parameters.set(SUPPORT_LOCATE.first, this->support_locate);
   parameters.set(SUPPORT_DISPLAY.first, this->support_display);
-  if(this->sa_samples != 0 && this->sa_samples->isWeighted())
+  if(this->getSASamples() != 0 && this->getSASamples()->isWeighted())
   {
     parameters.set(WEIGHTED_SAMPLES.first, 1);
   }
   else { parameters.set(WEIGHTED_SAMPLES); }
-  parameters.write(base_name + PARAMETERS_EXTENSION);
+  parameters.set(PSI_ENCODING.first, psi_encoding);
+  if(this->getSASamples() != 0) { parameters.set(SA_ENCODING.first, this->getSASamples()->getIndexEncoding()); }
+  else { parameters.set(SA_ENCODING.first, SAVector::getDefaultEncoding()); }
+  parameters.set(LOCATE_RUN_LENGTH.first, this->locate_run_length);
+  return parameters;
 }
 
 //--------------------------------------------------------------------------
 
 pair_type
 RLCSA::count(const std::string& pattern) const
+{
+  return this->count(pattern, (QueryContext*)0);
+}
+
+pair_type
+RLCSA::count(const std::string& pattern, QueryContext& context) const
+{
+  return this->count(pattern, &context);
+}
+
+pair_type
+RLCSA::count(const std::string& pattern, QueryContext* context) const
 {
   if(pattern.length() == 0) { return this->getSARange(); }
 
   std::string::const_reverse_iterator iter = pattern.rbegin();
-  pair_type index_range = this->getCharRange((uchar)*iter);
+  pair_type index_range;
+  usint code = KmerTable::NOT_A_KMER;
+  if(this->kmer_table != 0 && pattern.length() >= this->kmer_table->getK())
+  {
+    code = this->kmer_table->encode(pattern, pattern.length() - this->kmer_table->getK());
+  }
+  if(code != KmerTable::NOT_A_KMER)
+  {
+    index_range = this->kmer_table->getRange(code);
+    iter += this->kmer_table->getK() - 1;
+  }
+  else
+  {
+    index_range = this->getCharRange((uchar)*iter);
+  }
   
   if(isEmpty(index_range)) { return index_range; }
 
   for(++iter; iter != pattern.rend(); ++iter)
   {
-    index_range = this->LF(index_range, (uchar)*iter);
+    if(context != 0) { index_range = this->LF(index_range, (uchar)*iter, *context); }
+    else             { index_range = this->LF(index_range, (uchar)*iter); }
     
     if(isEmpty(index_range)) { return EMPTY_PAIR; }
   }
@@ -304,6 +877,36 @@ RLCSA::count(const std::string& pattern) const
   return index_range;
 }
 
+pair_type
+RLCSA::countWithToehold(const std::string& pattern, usint& toehold) const
+{
+  if(this->run_samples == 0) { return EMPTY_PAIR; }
+  if(pattern.length() == 0)
+  {
+    this->run_samples->getToehold(0, toehold);
+    return this->getSARange();
+  }
+
+  QueryContext context(*this);
+  std::string::const_reverse_iterator iter = pattern.rbegin();
+  pair_type index_range = this->getCharRange((uchar)*iter);
+  if(isEmpty(index_range)) { return EMPTY_PAIR; }
+  this->run_samples->getToehold(index_range.first - this->number_of_sequences, toehold);
+
+  for(++iter; iter != pattern.rend(); ++iter)
+  {
+    index_range = this->LF(index_range, (uchar)*iter, context);
+    if(isEmpty(index_range)) { return EMPTY_PAIR; }
+
+    // If the range does not start with a toehold, the first suffix of the previous
+    // range was preceded by the current character.
+    if(!(this->run_samples->getToehold(index_range.first - this->number_of_sequences, toehold))) { toehold--; }
+  }
+
+  this->convertToSARange(index_range);
+  return index_range;
+}
+
 //--------------------------------------------------------------------------
 
 void
@@ -311,7 +914,8 @@ RLCSA::reportPositions(uchar* data, usint length, usint* positions) const
 {
   if(data == 0 || length == 0 || positions == 0) { return; }
 
-  PsiVector::Iterator** iters = this->getIterators();
+  QueryContext context(*this);
+  PsiVector::Iterator** iters = context.iters;
 
   usint current = this->number_of_sequences - 1;
   positions[length] = current; // "immediately after current"
@@ -335,31 +939,113 @@ RLCSA::reportPositions(uchar* data, usint length, usint* positions) const
     }
     positions[i] = current; // "immediately after current"
   }
-
-  this->deleteIterators(iters);
 }
 
 //--------------------------------------------------------------------------
 
 usint*
-RLCSA::locate(pair_type range, bool direct, bool steps) const
+RLCSA::locate(pair_type range, locate_type strategy, bool steps) const
 {
-  if(!(this->support_locate) || isEmpty(range) || range.second >= this->data_size) { return 0; }
+  if(!(this->canLocate()) || isEmpty(range) || range.second >= this->data_size) { return 0; }
 
   usint* data = new usint[length(range)];
-  if(direct) { this->directLocate(range, data, steps); }
-  else       { this->locateUnsafe(range, data, steps); }
+  QueryContext context(*this);
+  this->locateWithStrategy(range, data, strategy, steps, context);
 
   return data;
 }
 
 usint*
-RLCSA::locate(pair_type range, usint* data, bool direct, bool steps) const
+RLCSA::locate(pair_type range, usint* data, locate_type strategy, bool steps) const
 {
-  if(!(this->support_locate) || isEmpty(range) || range.second >= this->data_size || data == 0) { return 0; }
+  if(!(this->canLocate()) || isEmpty(range) || range.second >= this->data_size || data == 0) { return 0; }
 
-  if(direct) { this->directLocate(range, data, steps); }
-  else       { this->locateUnsafe(range, data, steps); }
+  QueryContext context(*this);
+  this->locateWithStrategy(range, data, strategy, steps, context);
+
+  return data;
+}
+
+usint*
+RLCSA::locate(pair_type range, QueryContext& context, locate_type strategy, bool steps) const
+{
+  if(!(this->canLocate()) || isEmpty(range) || range.second >= this->data_size) { return 0; }
+
+  usint* data = new usint[length(range)];
+  this->locateWithStrategy(range, data, strategy, steps, context);
+
+  return data;
+}
+
+usint*
+RLCSA::locate(pair_type range, usint* data, QueryContext& context, locate_type strategy, bool steps) const
+{
+  if(!(this->canLocate()) || isEmpty(range) || range.second >= this->data_size || data == 0) { return 0; }
+
+  this->locateWithStrategy(range, data, strategy, steps, context);
+
+  return data;
+}
+
+usint*
+RLCSA::parallelLocate(pair_type range, usint threads, locate_type strategy, bool steps) const
+{
+  if(!(this->canLocate()) || isEmpty(range) || range.second >= this->data_size) { return 0; }
+
+  usint* data = new usint[length(range)];
+  return this->parallelLocate(range, data, threads, strategy, steps);
+}
+
+usint*
+RLCSA::parallelLocate(pair_type range, usint* data, usint threads, locate_type strategy, bool steps) const
+{
+  if(!(this->canLocate()) || isEmpty(range) || range.second >= this->data_size || data == 0) { return 0; }
+
+  #ifdef MULTITHREAD_SUPPORT
+  usint items = length(range);
+  if(threads > 1 && items >= PARALLEL_LOCATE_THRESHOLD)
+  {
+    // Use several chunks per thread, as the locate times of the chunks can vary a lot.
+    usint chunk_size = std::max((usint)PARALLEL_LOCATE_CHUNK, (items + 4 * threads - 1) / (4 * threads));
+    usint chunks = (items + chunk_size - 1) / chunk_size;
+    omp_set_num_threads(threads);
+    #pragma omp parallel
+    {
+      QueryContext context(*this);
+      #pragma omp for schedule(dynamic, 1)
+      for(sint chunk = 0; chunk < (sint)chunks; chunk++)
+      {
+        usint offset = chunk * chunk_size;
+        pair_type chunk_range(range.first + offset, std::min(range.first + offset + chunk_size - 1, range.second));
+        this->locateWithStrategy(chunk_range, data + offset, strategy, steps, context);
+      }
+    }
+    return data;
+  }
+  #endif
+
+  QueryContext context(*this);
+  this->locateWithStrategy(range, data, strategy, steps, context);
+
+  return data;
+}
+
+usint*
+RLCSA::locateFromToehold(pair_type range, usint toehold) const
+{
+  if(this->run_samples == 0 || isEmpty(range) || range.second >= this->data_size) { return 0; }
+
+  usint* data = new usint[length(range)];
+  return this->locateFromToehold(range, toehold, data);
+}
+
+usint*
+RLCSA::locateFromToehold(pair_type range, usint toehold, usint* data) const
+{
+  if(this->run_samples == 0 || isEmpty(range) || range.second >= this->data_size || data == 0) { return 0; }
+
+  data[0] = toehold;
+  for(usint i = 1; i < length(range); i++) { data[i] = this->run_samples->phi(data[i - 1]); }
 
   return data;
 }
@@ -367,35 +1053,102 @@ RLCSA::locate(pair_type range, usint* data, bool direct, bool steps) const
 usint
 RLCSA::locate(usint index, bool steps) const
 {
-  if(!(this->support_locate) || index >= this->data_size) { return (steps ? 0 : this->data_size); }
+  if(!(this->canLocate()) || index >= this->data_size) { return (steps ? 0 : this->data_size); }
+
+  return this->directLocate(index + this->number_of_sequences, steps, 0);
+}
+
+usint
+RLCSA::locate(usint index, QueryContext& context, bool steps) const
+{
+  if(!(this->canLocate()) || index >= this->data_size) { return (steps ? 0 : this->data_size); }
 
-  return this->directLocate(index + this->number_of_sequences, steps);
+  return this->directLocate(index + this->number_of_sequences, steps, &context);
 }
 
 usint
 RLCSA::inverseLocate(usint location) const
 {
-  if(!(this->support_locate)) { return this->data_size; }
+  if(!(this->supportsLocate())) { return this->data_size; }
   // TODO: Check for out-of-bounds locations somehow.
 
   // Inverse-locate the given location in BWT space, and convert back to SA
   // space before returning.
-  return this->directInverseLocate(location) - this->number_of_sequences;
+  return this->directInverseLocate(location, 0) - this->number_of_sequences;
+}
+
+usint
+RLCSA::inverseLocate(usint location, QueryContext& context) const
+{
+  if(!(this->supportsLocate())) { return this->data_size; }
+
+  return this->directInverseLocate(location, &context) - this->number_of_sequences;
+}
+
+usint*
+RLCSA::inverseLocate(const usint* locations, usint number, usint threads) const
+{
+  if(!(this->supportsLocate()) || locations == 0 || number == 0) { return 0; }
+
+  usint* data = new usint[number];
+  return this->inverseLocate(locations, number, data, threads);
+}
+
+usint*
+RLCSA::inverseLocate(const usint* locations, usint number, usint* data, usint threads) const
+{
+  if(!(this->supportsLocate()) || locations == 0 || number == 0 || data == 0) { return 0; }
+  threads = std::max(threads, (usint)1);
+
+  // Sort the values, remembering their original positions.
+  pair_type* order = new pair_type[number];
+  for(usint i = 0; i < number; i++) { order[i] = pair_type(locations[i], i); }
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #endif
+  parallelSort(order, order + number);
+
+  #ifdef MULTITHREAD_SUPPORT
+  if(threads > 1 && number >= PARALLEL_LOCATE_THRESHOLD)
+  {
+    usint chunk_size = std::max((usint)PARALLEL_LOCATE_CHUNK, (number + 4 * threads - 1) / (4 * threads));
+    usint chunks = (number + chunk_size - 1) / chunk_size;
+    omp_set_num_threads(threads);
+    #pragma omp parallel
+    {
+      QueryContext context(*this);
+      #pragma omp for schedule(dynamic, 1)
+      for(sint chunk = 0; chunk < (sint)chunks; chunk++)
+      {
+        usint offset = chunk * chunk_size;
+        this->inverseLocateSorted(order + offset, std::min(chunk_size, number - offset), data, context);
+      }
+    }
+    delete[] order;
+    return data;
+  }
+  #endif
+
+  QueryContext context(*this);
+  this->inverseLocateSorted(order, number, data, context);
+  delete[] order;
+
+  return data;
 }
 
 void
-RLCSA::directLocate(pair_type range, usint* data, bool steps) const
+RLCSA::directLocate(pair_type range, usint* data, bool steps, QueryContext* context) const
 {
   // range is in SA coordinates, so first we need to convert to BWT coordinates.
   this->convertToBWTRange(range);
   for(usint i = 0, j = range.first; j <= range.second; i++, j++)
   {
-    data[i] = this->directLocate(j, steps);
+    data[i] = this->directLocate(j, steps, context);
   }
 }
 
 usint
-RLCSA::directLocate(usint index, bool steps) const
+RLCSA::directLocate(usint index, bool steps, QueryContext* context) const
 {
   // Note that index is in BWT coordinates initially.
   
@@ -416,28 +1169,35 @@ RLCSA::directLocate(usint index, bool steps) const
     }
     // Pop index into SA space, where the SA samples live
     index -= this->number_of_sequences;
-    if(this->sa_samples->isSampled(index))
+    if(!(this->support_locate))
+    {
+      // Without SA samples, use the toeholds at the starts of Psi runs. A walk that
+      // never enters a new run still ends at the end of the sequence.
+      usint value = 0;
+      if(this->run_samples->getToehold(index, value)) { return (steps ? offset : value - offset); }
+    }
+    else if(this->getSASamples()->isSampled(index))
     {
       // If we took a real SA sample here, we know where it falls in the
       // original sequences.
-      return (steps ? offset : this->sa_samples->getSampleAt(index) - offset);
+      return (steps ? offset : this->getSASamples()->getSampleAt(index) - offset);
     }
     
     // If we get here, we couldn't map this position. Proceed forwards (towards
     // the end of the sequence), in hopes of hitting either a sample or the
     // sequence end character. Note that psi maps from SA position to the *BWT*
     // position of the subsequent character, popping index back into BWT space.
-    index = this->psi(index);
+    index = (context != 0 ? this->psi(index, context->iters) : this->psi(index));
     offset++;
   }
 }
 
 usint
-RLCSA::directInverseLocate(usint location) const
+RLCSA::directInverseLocate(usint location, QueryContext* context) const
 {
   // Get the SA value and SA index (in that order) of the last SA sample
   // before the given text location.
-  pair_type last_sample = this->sa_samples->inverseSA(location);
+  pair_type last_sample = this->getSASamples()->inverseSA(location);
   
   // TODO: catch the (size, size) sentinel.
   while(last_sample.first < location) {
@@ -449,8 +1209,8 @@ RLCSA::directInverseLocate(usint location) const
     // Advance the SA index to that corresponding to the next character. Note
     // that psi returns BWT coordinates, so we have to convert back to SA
     // coordinates.
-    last_sample.second = (this->psi(last_sample.second) - 
-      this->number_of_sequences);
+    last_sample.second = (context != 0 ? this->psi(last_sample.second, context->iters) : this->psi(last_sample.second));
+    last_sample.second -= this->number_of_sequences;
       
   }
   
@@ -467,14 +1227,42 @@ RLCSA::directInverseLocate(usint location) const
 }
 
 void
-RLCSA::locateUnsafe(pair_type range, usint* data, bool steps) const
+RLCSA::inverseLocateSorted(const pair_type* order, usint number, usint* data, QueryContext& context) const
+{
+  // current is (SA value, SA index) of the last position reached by the walk.
+  usint text_size = this->getTextSize();
+  pair_type current(text_size, 0);
+  for(usint i = 0; i < number; i++)
+  {
+    usint location = order[i].first;
+    if(location >= text_size) { data[order[i].second] = this->data_size; continue; }
+
+    // Continue the previous walk, unless the sample for this value is closer.
+    pair_type sample = this->getSASamples()->inverseSA(location);
+    if(current.first > location || current.first < sample.first) { current = sample; }
+    while(current.first < location)
+    {
+      current.first++;
+      current.second = this->psi(current.second, context.iters) - this->number_of_sequences;
+    }
+    data[order[i].second] = current.second;
+  }
+}
+
+void
+RLCSA::locateUnsafe(pair_type range, usint* data, bool steps, QueryContext& context) const
 {
+  if(this->run_samples != 0 && !steps)
+  {
+    this->locateFromToehold(range, this->directLocate(range.first + this->number_of_sequences, false, &context), data);
+    return;
+  }
+
   this->convertToBWTRange(range);
   usint items = length(range);
   usint* offsets = new usint[items];
   bool* finished = new bool[items];  // FIXME This could be more space efficient...
-
-  PsiVector::Iterator** iters = this->getIterators();
+  PsiVector::Iterator** iters = context.iters;
 
   for(usint i = 0, j = range.first; i < items; i++, j++)
   {
@@ -511,11 +1299,71 @@ RLCSA::locateUnsafe(pair_type range, usint* data, bool steps) const
     if(!isEmpty(run)) { found &= this->processRun(run, data, offsets, finished, iters, steps); }
   }
 
-  this->deleteIterators(iters);
   delete[] offsets;
   delete[] finished;
 }
 
+void
+RLCSA::adaptiveLocate(pair_type range, usint* data, bool steps, QueryContext& context) const
+{
+  if(length(range) < ADAPTIVE_LOCATE_MIN_RANGE)
+  {
+    this->directLocate(range, data, steps, &context);
+    return;
+  }
+  if(this->run_samples != 0 && !steps)
+  {
+    this->locateUnsafe(range, data, steps, context);
+    return;
+  }
+
+  // Find maximal segments of long or short runs, and locate each of them when it ends.
+  usint segment_start = range.first;
+  bool long_runs = false;
+  for(usint i = range.first; i <= range.second; )
+  {
+    pair_type run = this->psi(i, range.second - i, context.iters);
+    bool is_long = (run.second + 1 >= this->locate_run_length);
+    if(is_long != long_runs && i > segment_start)
+    {
+      pair_type segment(segment_start, i - 1);
+      usint* buffer = data + (segment_start - range.first);
+      if(long_runs) { this->locateUnsafe(segment, buffer, steps, context); }
+      else          { this->directLocate(segment, buffer, steps, &context); }
+      segment_start = i;
+    }
+    long_runs = is_long;
+    i += run.second + 1;
+  }
+
+  pair_type segment(segment_start, range.second);
+  usint* buffer = data + (segment_start - range.first);
+  if(long_runs) { this->locateUnsafe(segment, buffer, steps, context); }
+  else          { this->directLocate(segment, buffer, steps, &context); }
+}
+
+void
+RLCSA::locateWithStrategy(pair_type range, usint* data, locate_type strategy, bool steps, QueryContext& context) const
+{
+  // The other strategies need the SA samples for the positions after the first one.
+  if(!(this->supportsLocate()))
+  {
+    if(steps) { this->directLocate(range, data, steps, &context); }
+    else      { this->locateFromToehold(range, this->directLocate(range.first + this->number_of_sequences, false, &context), data); }
+    return;
+  }
+
+  switch(strategy)
+  {
+    case LOCATE_DIRECT:
+      this->directLocate(range, data, steps, &context); break;
+    case LOCATE_RUNS:
+      this->locateUnsafe(range, data, steps, context); break;
+    default:
+      this->adaptiveLocate(range, data, steps, context); break;
+  }
+}
+
 bool
 RLCSA::processRun(pair_type run, usint* data, usint* offsets, bool* finished, PsiVector::Iterator** iters, bool steps) const
 {
@@ -540,7 +1388,7 @@ RLCSA::processRun(pair_type run, usint* data, usint* offsets, bool* finished, Ps
     }
     if(next_sample.first < data[i]) // Need another sample.
     {
-      next_sample = this->sa_samples->getFirstSampleAfter(data[i] - this->number_of_sequences);
+      next_sample = this->getSASamples()->getFirstSampleAfter(data[i] - this->number_of_sequences);
       next_sample.first += this->number_of_sequences;
     }
     if(data[i] < next_sample.first) // No sample found for current position.
@@ -562,7 +1410,7 @@ RLCSA::processRun(pair_type run, usint* data, usint* offsets, bool* finished, Ps
     }
     else  // Sampled position found.
     {
-      data[i] = (steps ? offsets[i] : this->sa_samples->getSample(next_sample.second) - offsets[i]);
+      data[i] = (steps ? offsets[i] : this->getSASamples()->getSample(next_sample.second) - offsets[i]);
       finished[i] = true;
       if(run_left > 0) { run_left--; }
     }
@@ -575,7 +1423,7 @@ RLCSA::processRun(pair_type run, usint* data, usint* offsets, bool* finished, Ps
 uchar*
 RLCSA::display(usint sequence, bool include_end_marker) const
 {
-  if(!(this->support_display)) { return 0; }
+  if(!(this->supportsDisplay())) { return 0; }
 
   pair_type seq_range = this->getSequenceRange(sequence);
   if(isEmpty(seq_range)) { return 0; }
@@ -590,7 +1438,7 @@ RLCSA::display(usint sequence, bool include_end_marker) const
 uchar*
 RLCSA::display(usint sequence, pair_type range) const
 {
-  if(!(this->support_display) || isEmpty(range)) { return 0; }
+  if(!(this->supportsDisplay()) || isEmpty(range)) { return 0; }
 
   pair_type seq_range = this->getSequenceRange(sequence);
   if(isEmpty(seq_range)) { return 0; }
@@ -607,7 +1455,7 @@ RLCSA::display(usint sequence, pair_type range) const
 uchar*
 RLCSA::display(usint sequence, pair_type range, uchar* data) const
 {
-  if(!(this->support_display) || isEmpty(range) || data == 0) { return 0; }
+  if(!(this->supportsDisplay()) || isEmpty(range) || data == 0) { return 0; }
 
   pair_type seq_range = this->getSequenceRange(sequence);
   if(isEmpty(seq_range)) { return 0; }
@@ -619,10 +1467,40 @@ RLCSA::display(usint sequence, pair_type range, uchar* data) const
   return data;
 }
 
+uchar*
+RLCSA::parallelDisplay(usint sequence, usint threads, bool include_end_marker) const
+{
+  if(!(this->supportsDisplay())) { return 0; }
+
+  pair_type seq_range = this->getSequenceRange(sequence);
+  if(isEmpty(seq_range)) { return 0; }
+
+  uchar* data = new uchar[length(seq_range) + include_end_marker];
+  this->parallelDisplayUnsafe(seq_range, data, threads);
+  if(include_end_marker) { data[length(seq_range)] = 0; }
+
+  return data;
+}
+
+uchar*
+RLCSA::parallelDisplay(usint sequence, pair_type range, uchar* data, usint threads) const
+{
+  if(!(this->supportsDisplay()) || isEmpty(range) || data == 0) { return 0; }
+
+  pair_type seq_range = this->getSequenceRange(sequence);
+  if(isEmpty(seq_range)) { return 0; }
+
+  range.first += seq_range.first; range.second += seq_range.first;
+  if(range.second > seq_range.second) { return 0; }
+
+  this->parallelDisplayUnsafe(range, data, threads);
+  return data;
+}
+
 uchar*
 RLCSA::display(usint position, usint len, usint context, usint& result_length) const
 {
-  if(!(this->support_display)) { return 0; }
+  if(!(this->supportsDisplay())) { return 0; }
 
   pair_type range = this->getSequenceRangeForPosition(position);
   if(isEmpty(range)) { return 0; }
@@ -641,7 +1519,7 @@ RLCSA::display(usint position, usint len, usint context, usint& result_length) c
 usint
 RLCSA::displayPrefix(usint sequence, usint len, uchar* data) const
 {
-  if(!(this->support_display) || len == 0 || data == 0) { return 0; }
+  if(!(this->supportsDisplay()) || len == 0 || data == 0) { return 0; }
 
   pair_type seq_range = this->getSequenceRange(sequence);
   if(isEmpty(seq_range)) { return 0; }
@@ -654,13 +1532,26 @@ RLCSA::displayPrefix(usint sequence, usint len, uchar* data) const
 
 usint
 RLCSA::displayFromPosition(usint index, usint max_len, uchar* data) const
+{
+  return this->displayFromPosition(index, max_len, data, (QueryContext*)0);
+}
+
+usint
+RLCSA::displayFromPosition(usint index, usint max_len, uchar* data, QueryContext& context) const
+{
+  return this->displayFromPosition(index, max_len, data, &context);
+}
+
+usint
+RLCSA::displayFromPosition(usint index, usint max_len, uchar* data, QueryContext* context) const
 {
   if(max_len == 0 || data == 0 || index >= this->data_size) { return 0; }
 
   for(usint i = 0; i < max_len; i++)
   {
     data[i] = this->getCharacter(index);
-    index = this->psiUnsafe(index, data[i]);
+    if(context != 0) { index = this->psiUnsafe(index, data[i], *(context->iters[data[i]])); }
+    else             { index = this->psiUnsafe(index, data[i]); }
     if(index < this->number_of_sequences) { return i + 1; }
     index -= this->number_of_sequences;
   }
@@ -671,12 +1562,20 @@ RLCSA::displayFromPosition(usint index, usint max_len, uchar* data) const
 void
 RLCSA::displayUnsafe(pair_type range, uchar* data, bool get_ranks, usint* ranks) const
 {
-  pair_type res = this->sa_samples->inverseSA(range.first);
+  if(!(this->getSASamples()->isWeighted()) && length(range) >= DISPLAY_RUN_THRESHOLD * this->getSASamples()->getSampleRate())
+  {
+    QueryContext context(*this);
+    this->displayRuns(range, data, get_ranks, ranks, context);
+    return;
+  }
+
+  pair_type res = this->getSASamples()->inverseSA(range.first);
   usint i = res.first, pos = res.second;
 
   if(length(range) >= 1024)
   {
-    PsiVector::Iterator** iters = this->getIterators();
+    QueryContext context(*this);
+    PsiVector::Iterator** iters = context.iters;
     for(; i < range.first; i++)
     {
       pos = this->psi(pos, iters) - this->number_of_sequences;
@@ -688,7 +1587,6 @@ RLCSA::displayUnsafe(pair_type range, uchar* data, bool get_ranks, usint* ranks)
       if(get_ranks) { ranks[i - range.first] = pos + this->number_of_sequences; }
       pos = this->psiUnsafe(pos, c, *(iters[c])) - this->number_of_sequences;
     }
-    this->deleteIterators(iters);
   }
   else
   {
@@ -706,6 +1604,91 @@ RLCSA::displayUnsafe(pair_type range, uchar* data, bool get_ranks, usint* ranks)
   }
 }
 
+void
+RLCSA::parallelDisplayUnsafe(pair_type range, uchar* data, usint threads) const
+{
+  #ifdef MULTITHREAD_SUPPORT
+  usint items = length(range);
+  if(threads > 1 && items >= PARALLEL_DISPLAY_THRESHOLD)
+  {
+    // The chunks start at sample boundaries, except for the first one. Display takes
+    // about the same time for each position, so one chunk per thread is enough.
+    // Larger chunks also keep more walkers together in displayRuns().
+    usint rate = std::max(this->getSASamples()->getSampleRate(), (usint)1);
+    usint chunk_size = std::max((usint)PARALLEL_DISPLAY_CHUNK, (items + threads - 1) / threads);
+    chunk_size = nextMultipleOf(rate, chunk_size - 1);
+    usint first_end = range.first - range.first % rate + chunk_size - 1;
+    usint chunks = 1 + (range.second > first_end ? (range.second - first_end + chunk_size - 1) / chunk_size : 0);
+    omp_set_num_threads(threads);
+    #pragma omp parallel for schedule(static, 1)
+    for(sint chunk = 0; chunk < (sint)chunks; chunk++)
+    {
+      pair_type chunk_range(range.first, std::min(first_end, range.second));
+      if(chunk > 0)
+      {
+        chunk_range.first = first_end + 1 + (chunk - 1) * chunk_size;
+        chunk_range.second = std::min(chunk_range.first + chunk_size - 1, range.second);
+      }
+      this->displayUnsafe(chunk_range, data + (chunk_range.first - range.first));
+    }
+    return;
+  }
+  #endif
+
+  this->displayUnsafe(range, data);
+}
+
+void
+RLCSA::displayRuns(pair_type range, uchar* data, bool get_ranks, usint* ranks, QueryContext& context) const
+{
+  // Start a walker from each sample in the range as (SA index, text position).
+  usint rate = this->getSASamples()->getSampleRate();
+  std::vector<pair_type> walkers, next;
+  std::vector<usint> groups;
+  for(usint pos = range.first - range.first % rate; pos <= range.second; pos += rate)
+  {
+    walkers.push_back(pair_type(this->getSASamples()->inverseSA(pos).second, pos));
+  }
+  std::sort(walkers.begin(), walkers.end());
+
+  PsiVector::Iterator** iters = context.iters;
+  while(!(walkers.empty()))
+  {
+    // Psi is linear within a run, so the walkers in the same run share the select.
+    pair_type run = EMPTY_PAIR;
+    usint run_value = 0, prev_c = CHARS;
+    next.clear(); groups.clear();
+    for(usint i = 0; i < walkers.size(); i++)
+    {
+      usint index = walkers[i].first, pos = walkers[i].second;
+      usint c = this->getCharacter(index);
+      if(c != prev_c) { groups.push_back(next.size()); prev_c = c; }
+      if(pos >= range.first)
+      {
+        data[pos - range.first] = c;
+        if(get_ranks) { ranks[pos - range.first] = index + this->number_of_sequences; }
+      }
+      pos++;
+      if(pos > range.second || pos % rate == 0) { continue; } // The next walker continues from here.
+
+      if(index < run.first || index > run.second)
+      {
+        pair_type psi_run = iters[c]->selectRun(index - this->alphabet->cumulative(c), walkers.back().first - index);
+        run = pair_type(index, index + psi_run.second); run_value = psi_run.first;
+      }
+      next.push_back(pair_type(run_value + (index - run.first) - this->number_of_sequences, pos));
+    }
+
+    // Psi is increasing within each character, so the groups only need to be merged.
+    for(usint i = 1; i < groups.size(); i++)
+    {
+      std::vector<pair_type>::iterator end = (i + 1 < groups.size() ? next.begin() + groups[i + 1] : next.end());
+      std::inplace_merge(next.begin(), next.begin() + groups[i], end);
+    }
+    walkers.swap(next);
+  }
+}
+
 //--------------------------------------------------------------------------
 
 pair_type
@@ -765,11 +1748,24 @@ RLCSA::LF(pair_type range, usint c) const
   return range;
 }
 
+pair_type
+RLCSA::LF(pair_type range, usint c, QueryContext& context) const
+{
+  if(c >= CHARS || this->array[c] == 0) { return EMPTY_PAIR; }
+  PsiVector::Iterator& iter = *(context.iters[c]);
+
+  usint start = this->alphabet->cumulative(c) + this->number_of_sequences - 1;
+  range.first = start + iter.rank(range.first, true);
+  range.second = start + iter.rank(range.second);
+
+  return range;
+}
+
 std::vector<usint>*
 RLCSA::locateRange(pair_type range) const
 {
   std::vector<usint>* results = new std::vector<usint>;
-  if(!(this->support_locate)) { return results; }
+  if(!(this->canLocate())) { return results; }
 
   this->locateRange(range, *results);
   removeDuplicates(results, false);
@@ -783,7 +1779,8 @@ RLCSA::locateRange(pair_type range, std::vector<usint>& vec) const
   if(isEmpty(range) || range.second >= this->data_size) { return; }
 
   usint* data = new usint[length(range)];
-  this->locateUnsafe(range, data, false);
+  QueryContext context(*this);
+  this->locateUnsafe(range, data, false, context);
   for(usint i = 0; i < length(range); i++) { vec.push_back(data[i]); }
   delete[] data;
 }
@@ -792,7 +1789,7 @@ std::vector<usint>*
 RLCSA::locateRanges(std::vector<pair_type>& ranges) const
 {
   std::vector<usint>* results = new std::vector<usint>;
-  if(!(this->support_locate)) { return results; }
+  if(!(this->canLocate())) { return results; }
 
   for(std::vector<pair_type>::iterator iter = ranges.begin(); iter != ranges.end(); ++iter)
   {
@@ -841,16 +1838,11 @@ RLCSA::getSequenceRangeForPosition(usint value) const
 }
 
 usint*
-RLCSA::getSequenceForPosition(usint* values, usint len) const
+RLCSA::getSequenceForPosition(usint* values, usint len, usint threads) const
 {
   if(values == 0) { return 0; }
 
-  DeltaVector::Iterator iter(*(this->end_points));
-  for(usint i = 0; i < len; i++)
-  {
-    if(values[i] > 0) { values[i] = iter.rank(values[i] - 1); }
-  }
-
+  this->convertPositions(values, len, values, 0, threads);
   return values;
 }
 
@@ -880,6 +1872,155 @@ RLCSA::getRelativePosition(usint value) const
   return result;
 }
 
+pair_type*
+RLCSA::getRelativePosition(const usint* values, usint len, usint threads) const
+{
+  if(values == 0) { return 0; }
+
+  pair_type* results = new pair_type[len];
+  this->convertPositions(values, len, 0, results, threads);
+  return results;
+}
+
+void
+RLCSA::convertPositions(const usint* values, usint len, usint* sequences, pair_type* relative, usint threads) const
+{
+  if(len == 0) { return; }
+
+  bool sorted = true;
+  for(usint i = 1; i < len; i++)
+  {
+    if(values[i] < values[i - 1]) { sorted = false; break; }
+  }
+
+  // Sorting pays off with relative positions, as they need both rank and select, and
+  // when the end points are too large for the per-value searches to stay in cache.
+  // With few sequences, the searches are cheap anyway.
+  bool sort = (len >= SORTED_CONVERSION_THRESHOLD && this->number_of_sequences >= SORTED_CONVERSION_THRESHOLD &&
+    (relative != 0 || this->number_of_sequences >= SORTED_CONVERSION_SEQUENCES));
+  if(sorted || !sort)
+  {
+    this->convertChunks(values, len, sequences, relative, sorted, threads);
+    return;
+  }
+
+  // Sort the values with their original positions, convert, and put the results back.
+  std::vector<pair_type> order(len);
+  for(usint i = 0; i < len; i++) { order[i] = pair_type(values[i], i); }
+  if(threads > 1) { parallelSort(order.begin(), order.end()); }
+  else            { sequentialSort(order.begin(), order.end()); }
+
+  usint* buffer = new usint[len];
+  for(usint i = 0; i < len; i++) { buffer[i] = order[i].first; }
+  pair_type* relative_buffer = (relative != 0 ? new pair_type[len] : 0);
+  this->convertChunks(buffer, len, (sequences != 0 ? buffer : 0), relative_buffer, true, threads);
+  for(usint i = 0; i < len; i++)
+  {
+    if(sequences != 0) { sequences[order[i].second] = buffer[i]; }
+    if(relative != 0) { relative[order[i].second] = relative_buffer[i]; }
+  }
+  delete[] buffer;
+  delete[] relative_buffer;
+}
+
+void
+RLCSA::convertChunks(const usint* values, usint len, usint* sequences, pair_type* relative, bool sorted, usint threads) const
+{
+  #ifdef MULTITHREAD_SUPPORT
+  if(threads > 1 && len >= PARALLEL_CONVERSION_THRESHOLD)
+  {
+    usint chunk_size = (len + threads - 1) / threads;
+    omp_set_num_threads(threads);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(sint chunk = 0; chunk < (sint)threads; chunk++)
+    {
+      usint offset = chunk * chunk_size;
+      if(offset >= len) { continue; }
+      usint chunk_length = std::min(chunk_size, len - offset);
+      usint* chunk_sequences = (sequences != 0 ? sequences + offset : 0);
+      pair_type* chunk_relative = (relative != 0 ? relative + offset : 0);
+      if(sorted) { this->scanSortedPositions(values + offset, chunk_length, chunk_sequences, chunk_relative); }
+      else       { this->searchPositions(values + offset, chunk_length, chunk_sequences, chunk_relative); }
+    }
+    return;
+  }
+  #endif
+
+  if(sorted) { this->scanSortedPositions(values, len, sequences, relative); }
+  else       { this->searchPositions(values, len, sequences, relative); }
+}
+
+void
+RLCSA::searchPositions(const usint* values, usint len, usint* sequences, pair_type* relative) const
+{
+  DeltaVector::Iterator iter(*(this->end_points));
+  for(usint i = 0; i < len; i++)
+  {
+    usint value = values[i];
+    usint sequence = (value > 0 ? iter.rank(value - 1) : 0);
+    if(relative != 0)
+    {
+      relative[i] = pair_type(sequence, value);
+      if(sequence > 0) { relative[i].second -= nextMultipleOf(this->sample_rate, iter.select(sequence - 1)); }
+    }
+    if(sequences != 0) { sequences[i] = sequence; }
+  }
+}
+
+void
+RLCSA::scanSortedPositions(const usint* values, usint len, usint* sequences, pair_type* relative) const
+{
+  if(len == 0) { return; }
+  if(this->number_of_sequences == 0)
+  {
+    for(usint i = 0; i < len; i++)
+    {
+      if(relative != 0) { relative[i] = pair_type(0, values[i]); }
+      if(sequences != 0) { sequences[i] = 0; }
+    }
+    return;
+  }
+
+  // end is (the first end point >= value, its rank), and the rank is the sequence.
+  // Values after the last end point belong to sequence number_of_sequences.
+  DeltaVector::Iterator iter(*(this->end_points));
+  DeltaVector::Iterator select_iter(*(this->end_points));
+  usint last_end = select_iter.select(this->number_of_sequences - 1);
+  pair_type end(WORD_MAX, this->number_of_sequences);
+  usint start = nextMultipleOf(this->sample_rate, last_end);
+  if(values[0] <= last_end)
+  {
+    end = iter.valueAfter(values[0]);
+    start = (end.second > 0 ? nextMultipleOf(this->sample_rate, select_iter.select(end.second - 1)) : 0);
+  }
+
+  for(usint i = 0; i < len; i++)
+  {
+    usint value = values[i];
+    if(value > end.first)
+    {
+      if(value > last_end)
+      {
+        end = pair_type(WORD_MAX, this->number_of_sequences);
+        start = nextMultipleOf(this->sample_rate, last_end);
+      }
+      else
+      {
+        usint previous = end.first;
+        end = iter.nextValue();
+        if(end.first >= value) { start = nextMultipleOf(this->sample_rate, previous); }
+        else
+        {
+          end = iter.valueAfter(value);
+          start = nextMultipleOf(this->sample_rate, select_iter.select(end.second - 1));
+        }
+      }
+    }
+    if(sequences != 0) { sequences[i] = end.second; }
+    if(relative != 0) { relative[i] = pair_type(end.second, (end.second > 0 ? value - start : value)); }
+  }
+}
+
 usint
 RLCSA::getAbsolutePosition(pair_type position) const
 {
@@ -974,24 +2115,55 @@ RLCSA::getSuffixArrayForSequence(usint number) const
 
 //--------------------------------------------------------------------------
 
-PsiVector::Iterator**
-RLCSA::getIterators() const
+QueryContext::QueryContext(const RLCSA& rlcsa)
+{
+  for(usint c = 0; c < CHARS; c++)
+  {
+    if(rlcsa.array[c] == 0) { this->iters[c] = 0; }
+    else                    { this->iters[c] = new PsiVector::Iterator(*(rlcsa.array[c])); }
+  }
+}
+
+QueryContext::~QueryContext()
+{
+  for(usint c = 0; c < CHARS; c++) { delete this->iters[c]; }
+}
+
+//--------------------------------------------------------------------------
+
+LocateCursor::LocateCursor(const RLCSA& _rlcsa, pair_type _range, usint _batch_size, locate_type _strategy, bool _steps) :
+  rlcsa(_rlcsa), range(_range), batch_size(std::max(_batch_size, (usint)1)),
+  strategy(_strategy), steps(_steps),
+  next_position(_range.first), batch_start(_range.first), batch_length(0),
+  buffer(0),
+  context(_rlcsa)
 {
-  PsiVector::Iterator** iters = new PsiVector::Iterator*[CHARS];
-  for(usint i = 0; i < CHARS; i++)
+  if(isEmpty(this->range) || this->range.second >= this->rlcsa.getSize() || !(this->rlcsa.canLocate()))
   {
-    if(this->array[i] == 0) { iters[i] = 0; }
-    else                    { iters[i] = new PsiVector::Iterator(*(this->array[i])); }
+    this->range = EMPTY_PAIR; this->next_position = this->range.first;
+    return;
   }
-  return iters;
+  this->buffer = new usint[std::min(this->batch_size, length(this->range))];
 }
 
-void
-RLCSA::deleteIterators(PsiVector::Iterator** iters) const
+LocateCursor::~LocateCursor()
+{
+  delete[] this->buffer; this->buffer = 0;
+}
+
+usint
+LocateCursor::next()
 {
-  if(iters == 0) { return; }
-  for(usint i = 0; i < CHARS; i++) { delete iters[i]; }
-  delete[] iters;
+  this->batch_length = 0;
+  if(!(this->hasNext())) { return 0; }
+
+  this->batch_start = this->next_position;
+  pair_type batch(this->batch_start, std::min(this->batch_start + this->batch_size - 1, this->range.second));
+  this->rlcsa.locate(batch, this->buffer, this->context, this->strategy, this->steps);
+  this->batch_length = length(batch);
+  this->next_position = batch.second + 1;
+
+  return this->batch_length;
 }
 
 //--------------------------------------------------------------------------
@@ -1016,12 +2188,27 @@ RLCSA::reportSize(bool print) const
     std::cout << "  BWT only:      " << (bwt / (double)MEGABYTE) << " MB" << std::endl;
   }
 
-  if(this->support_locate || this->support_display)
+  if(this->sa_samples != 0)
   {
     temp = this->sa_samples->reportSize();
     if(print) { std::cout << "SA samples:      " << (temp / (double)MEGABYTE) << " MB" << std::endl; }
     bytes += temp;
   }
+  else if(this->samples_pending && print) { std::cout << "SA samples:      not loaded" << std::endl; }
+
+  if(this->run_samples != 0)
+  {
+    temp = this->run_samples->reportSize();
+    if(print) { std::cout << "Run samples:     " << (temp / (double)MEGABYTE) << " MB" << std::endl; }
+    bytes += temp;
+  }
+
+  if(this->kmer_table != 0)
+  {
+    temp = this->kmer_table->reportSize();
+    if(print) { std::cout << "k-mer table:     " << (temp / (double)MEGABYTE) << " MB" << std::endl; }
+    bytes += temp;
+  }
 
   if(print)
   {
@@ -1032,6 +2219,47 @@ RLCSA::reportSize(bool print) const
   return bytes;
 }
 
+usint
+RLCSA::getPsiEncoding() const
+{
+  usint encoding = PsiVector::AUTOMATIC;
+  for(usint c = 0; c < CHARS; c++)
+  {
+    if(this->array[c] == 0) { continue; }
+    if(encoding == PsiVector::AUTOMATIC) { encoding = this->array[c]->getEncoding(); }
+    else if(encoding != this->array[c]->getEncoding()) { return PsiVector::MIXED; }
+  }
+  return (encoding == PsiVector::AUTOMATIC ? PsiVector::RLE : encoding);
+}
+
+std::vector<usint>
+RLCSA::getIdentity() const
+{
+  std::vector<usint> identity(INDEX_IDENTITY_WORDS, 0);
+  identity[0] = this->data_size;
+  identity[1] = this->getTextSize();
+  identity[2] = this->number_of_sequences;
+
+  // The end points, the character counts, and the encoded Psi vectors.
+  usint hash = WORD_HASH_OFFSET;
+  DeltaVector::Iterator iter(*(this->end_points));
+  for(usint i = 0; i < this->number_of_sequences; i++)
+  {
+    usint value = (i == 0 ? iter.select(0) : iter.selectNext());
+    hash = hashWords(&value, 1, hash);
+  }
+  for(usint c = 0; c < CHARS; c++)
+  {
+    if(this->array[c] == 0) { continue; }
+    usint counts[2] = { c, this->alphabet->countOf(c) };
+    hash = hashWords(counts, 2, hash);
+    hash = this->array[c]->checksum(hash);
+  }
+  identity[3] = hash;
+
+  return identity;
+}
+
 void
 RLCSA::printInfo() const
 {
@@ -1040,12 +2268,20 @@ RLCSA::printInfo() const
   std::cout << "Sequences:       " << this->number_of_sequences << std::endl;
   std::cout << "Original size:   " << megabytes << " MB" << std::endl;
   std::cout << "Block size:      " << (this->getBlockSize() * sizeof(usint)) << " bytes" << std::endl;
+  std::cout << "Psi encoding:    " << PsiVector::encodingName(this->getPsiEncoding()) << std::endl;
   if(this->support_locate || this->support_display)
   {
     std::cout << "Sample rate:     " << this->sample_rate;
-    if(this->sa_samples->isWeighted()) { std::cout << " (weighted)"; }
+    bool weighted = (this->sa_samples != 0 ? this->sa_samples->isWeighted() : this->samples_parameters.get(WEIGHTED_SAMPLES));
+    if(weighted) { std::cout << " (weighted)"; }
     std::cout << std::endl;
   }
+  if(this->run_samples != 0)
+  {
+    std::cout << "Run samples:     " << this->run_samples->getNumberOfToeholds() << " toeholds, "
+              << this->run_samples->getNumberOfPhiSamples() << " phi samples" << std::endl;
+  }
+  if(this->kmer_table != 0) { std::cout << "k-mer table:     k = " << this->kmer_table->getK() << std::endl; }
   std::cout << std::endl;
 }
 
@@ -1060,7 +2296,8 @@ RLCSA::buildPLCP(usint block_size) const
     return 0;
   }
 
-  PsiVector::Iterator** iters = this->getIterators();
+  QueryContext context(*this);
+  PsiVector::Iterator** iters = context.iters;
 
   PLCPVector::Encoder plcp(block_size);
   std::list<pair_type> matches;
@@ -1076,7 +2313,7 @@ RLCSA::buildPLCP(usint block_size) const
     prev_range = seq_range;
 
     usint maximal = seq_range.first;
-    usint x = this->sa_samples->inverseSA(seq_range.first).second, next_x;
+    usint x = this->getSASamples()->inverseSA(seq_range.first).second, next_x;
 
     // Invariant: x == inverseSA(i)
     for(usint i = seq_range.first; i <= seq_range.second; i++, x = next_x)
@@ -1139,8 +2376,6 @@ RLCSA::buildPLCP(usint block_size) const
     }
   }
 
-  this->deleteIterators(iters);
-
   plcp.flush();
   return new PLCPVector(plcp, 2 * (this->end_points->getSize() + 1));
 }
@@ -1170,7 +2405,8 @@ RLCSA::buildPLCP(usint block_size, usint threads) const
   #pragma omp parallel for schedule(dynamic, 1)
   for(usint j = 0; j < this->number_of_sequences; j++)
   {
-    PsiVector::Iterator** iters = this->getIterators();
+    QueryContext context(*this);
+    PsiVector::Iterator** iters = context.iters;
     std::list<pair_type> matches;
     PLCPVector::Encoder& plcp = *(plcp_encoders[omp_get_thread_num()]);
 
@@ -1183,7 +2419,7 @@ RLCSA::buildPLCP(usint block_size, usint threads) const
     }
 
     usint maximal = seq_range.first;
-    usint x = this->sa_samples->inverseSA(seq_range.first).second, next_x;
+    usint x = this->getSASamples()->inverseSA(seq_range.first).second, next_x;
 
     // Invariant: x == inverseSA(i)
     for(usint i = seq_range.first; i <= seq_range.second; i++, x = next_x)
@@ -1244,10 +2480,8 @@ RLCSA::buildPLCP(usint block_size, usint threads) const
     {
       this->encodePLCPRun(plcp, maximal, seq_range.second + 1, seq_range.second + 1 - maximal);
     }
-    this->deleteIterators(iters);
   }
 
-
   // Produce vectors from each of the threads and merge them to get the final vector.
   PLCPVector* temp_vecs[threads];
   for(usint i = 0; i < threads; i++)
@@ -1300,7 +2534,8 @@ RLCSA::sampleLCP(usint sample_rate, pair_type*& sampled_values, bool report) con
     sample_rate = this->data_size + 1;
   }
 
-  PsiVector::Iterator** iters = this->getIterators();
+  QueryContext context(*this);
+  PsiVector::Iterator** iters = context.iters;
 
   usint runs = this->countRuns();
   usint samples = 0, minimal_sum = 0, nonstrict_minimal_sum = 0, minimal_samples = 0;
@@ -1312,7 +2547,7 @@ RLCSA::sampleLCP(usint sample_rate, pair_type*& sampled_values, bool report) con
   {
     pair_type seq_range = this->getSequenceRange(j);
     usint first_sample = samples; // First minimal sample of the current sequence.
-    usint i, x = this->sa_samples->inverseSA(seq_range.first).second, next_x;
+    usint i, x = this->getSASamples()->inverseSA(seq_range.first).second, next_x;
 
     // Invariant: x == inverseSA(i)
     for(i = seq_range.first; i <= seq_range.second; i++, x = next_x)
@@ -1402,7 +2637,7 @@ RLCSA::sampleLCP(usint sample_rate, pair_type*& sampled_values, bool report) con
     if(sample_rate <= this->data_size)
     {
       usint last_sample = samples - 1;
-      i = seq_range.first; x = this->sa_samples->inverseSA(seq_range.first).second;
+      i = seq_range.first; x = this->getSASamples()->inverseSA(seq_range.first).second;
       for(usint current_sample = first_sample; current_sample <= last_sample; current_sample++)
       {
         // Find the next minimal sample and add nonminimal samples if needed.
@@ -1438,8 +2673,6 @@ RLCSA::sampleLCP(usint sample_rate, pair_type*& sampled_values, bool report) con
     std::cout << std::endl;
   }
 
-  this->deleteIterators(iters);
-
   return samples;
 }
 
@@ -1527,7 +2760,7 @@ RLCSA::mergeEndPoints(RLCSA& index, RLCSA& increment)
 void
 RLCSA::mergeSamples(RLCSA& index, RLCSA& increment, usint* positions)
 {
-  if(index.sa_samples == 0 || increment.sa_samples == 0) { return; }
+  if(index.getSASamples() == 0 || increment.getSASamples() == 0) { return; }
 
   positions += increment.number_of_sequences;
   this->sa_samples = new SASamples(*(index.sa_samples), *(increment.sa_samples), positions, increment.data_size, this->number_of_sequences);
@@ -1545,10 +2778,38 @@ RLCSA::strip()
   {
     if(this->array[c] != 0) { this->array[c]->strip(); }
   }
-  if(this->sa_samples != 0) { this->sa_samples->strip(); }
+  if(this->getSASamples() != 0) { this->sa_samples->strip(); }
   this->end_points->strip();
 }
 
+void
+RLCSA::sampleSequence(usint number, const usint* offsets, usint count, pair_type* output, QueryContext& context) const
+{
+  // BWT index number is the end marker of the sequence, located at offset length(range).
+  pair_type range = this->getSequenceRange(number);
+  usint bwt_index = number, offset = length(range);
+  usint alphabet_size = this->alphabet->getAlphabetSize(), c = this->alphabet->getFirstChar();
+
+  for(usint i = count; i > 0; i--)
+  {
+    while(offset > offsets[i - 1])
+    {
+      // Find BWT[bwt_index], trying the previous character first.
+      if(!(context.iters[c]->isSet(bwt_index)))
+      {
+        for(usint j = 0; j < alphabet_size; j++)
+        {
+          c = this->alphabet->getTextChar(j);
+          if(context.iters[c]->isSet(bwt_index)) { break; }
+        }
+      }
+      bwt_index = this->LF(bwt_index, c, *(context.iters[c]));
+      offset--;
+    }
+    output[i - 1] = pair_type(bwt_index - this->number_of_sequences, range.first + offset);
+  }
+}
+
 //--------------------------------------------------------------------------
 
 void
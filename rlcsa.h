@@ -6,16 +6,22 @@
 
 #include "bits/deltavector.h"
 #include "bits/rlevector.h"
-#include "bits/nibblevector.h"
+#include "bits/psivector.h"
 #include "bits/succinctvector.h"
 
 #include "sasamples.h"
 #include "alphabet.h"
+#include "kmertable.h"
+#include "runsamples.h"
 #include "lcpsamples.h"
 #include "misc/parameters.h"
 #include "sampler.h"
 #include "suffixarray.h"
 
+#ifdef MULTITHREAD_SUPPORT
+#include <omp.h>
+#endif
+
 namespace CSA
 {
 
@@ -23,24 +29,46 @@ namespace CSA
 const std::string PSI_EXTENSION = ".psi";
 const std::string ARRAY_EXTENSION = ".rlcsa.array";
 const std::string SA_SAMPLES_EXTENSION = ".rlcsa.sa_samples";
+const std::string RUN_SAMPLES_EXTENSION = ".rlcsa.run_samples";
+const std::string SAMPLE_CACHE_EXTENSION = ".rlcsa.sample_cache";
 const std::string PARAMETERS_EXTENSION = ".rlcsa.parameters";
 const std::string DOCUMENT_EXTENSION = ".rlcsa.docs";
 const std::string LCP_SAMPLES_EXTENSION = ".lcp_samples";
 const std::string PLCP_EXTENSION = ".plcp";
+const std::string KMER_TABLE_EXTENSION = ".kmer_table";
+const std::string CONTAINER_EXTENSION = ".rlcsa.index";
+
+// Psi array and SA sample files starting with INDEX_FILE_MAGIC continue with the format
+// version. Version 1 stores the rank/select indexes of the vectors and the inverse SA
+// samples, so that loading does not rebuild them. In version 2, the Psi array file has a
+// table of the sample rate and the offsets of the vectors after the character distribution,
+// so that the vectors can be loaded in parallel. Files without the header have version 0.
+const usint INDEX_FILE_MAGIC = (usint)0x5844494153434C52ULL;  // "RLCSAIDX"
+const usint INDEX_FILE_VERSION = 2;
 
+// Files built separately for an existing index store the identity of the index.
+const usint INDEX_IDENTITY_WORDS = 4;
 
+
+// If PSI_ENCODING or SA_ENCODING is missing, the index uses the default encodings of
+// PsiVector and SAVector.
 const parameter_type RLCSA_BLOCK_SIZE  = parameter_type("RLCSA_BLOCK_SIZE", 32);
 const parameter_type SAMPLE_RATE       = parameter_type("SAMPLE_RATE", 128);
 const parameter_type SUPPORT_LOCATE    = parameter_type("SUPPORT_LOCATE", 1);
 const parameter_type SUPPORT_DISPLAY   = parameter_type("SUPPORT_DISPLAY", 1);
 const parameter_type WEIGHTED_SAMPLES  = parameter_type("WEIGHTED_SAMPLES", 0);
+const parameter_type PSI_ENCODING      = parameter_type("PSI_ENCODING", (usint)PsiVector::RLE);
+const parameter_type SA_ENCODING       = parameter_type("SA_ENCODING", (usint)SAVector::DELTA);
+const parameter_type LOCATE_RUN_LENGTH = parameter_type("LOCATE_RUN_LENGTH", 4);
 
 
-#ifdef USE_NIBBLE_VECTORS
-typedef NibbleVector  PsiVector;
-#else
-typedef RLEVector     PsiVector;
-#endif
+/*
+  Strategies for locating SA ranges. Run-based locate processes the range as runs
+  of Psi, and is fast for large ranges in repetitive collections. Direct locate
+  processes one position at a time. Adaptive locate chooses between them.
+*/
+enum locate_type { LOCATE_RUNS, LOCATE_DIRECT, LOCATE_ADAPTIVE };
+
 
 #ifdef SUCCINCT_LCP_VECTOR
 typedef SuccinctVector PLCPVector;
@@ -49,9 +77,92 @@ typedef RLEVector PLCPVector;
 #endif
 
 
+class RLCSA;
+
+
+/*
+  Reusable Psi iterators for the characters appearing in an RLCSA. Queries given a
+  context use its iterators instead of constructing their own. A context may only be
+  used by one thread at a time and only with the index it was created for.
+*/
+
+class QueryContext
+{
+  friend class RLCSA;
+
+  public:
+    explicit QueryContext(const RLCSA& rlcsa);
+    ~QueryContext();
+
+    // Returns 0 if c does not appear in the collection.
+    inline PsiVector::Iterator* operator[] (usint c) const { return this->iters[c]; }
+
+  protected:
+    PsiVector::Iterator* iters[CHARS];
+
+    // These are not allowed.
+    QueryContext();
+    QueryContext(const QueryContext&);
+    QueryContext& operator = (const QueryContext&);
+};
+
+
+/*
+  Locates an SA range in batches of at most batch_size positions. Each batch is
+  located in the same way as locate(range), so memory usage is bounded by the
+  batch size, and the caller can stop early. A cursor may only be used by one
+  thread at a time, and the index must outlive it.
+*/
+
+class LocateCursor
+{
+  public:
+    const static usint DEFAULT_BATCH_SIZE = 4096;
+
+    LocateCursor(const RLCSA& rlcsa, pair_type range, usint batch_size = DEFAULT_BATCH_SIZE,
+      locate_type strategy = LOCATE_ADAPTIVE, bool steps = false);
+    ~LocateCursor();
+
+    // Locates the next batch and returns its size. Returns 0 when the range has
+    // been exhausted or if the index does not support locate.
+    usint next();
+
+    // The values located by the last call to next(), in SA order.
+    inline const usint* getBatch() const { return this->buffer; }
+    inline usint getBatchLength() const { return this->batch_length; }
+
+    // SA position of the first value in the current batch.
+    inline usint getBatchStart() const { return this->batch_start; }
+
+    inline bool hasNext() const { return (this->next_position <= this->range.second); }
+    inline usint getRemaining() const { return (this->hasNext() ? this->range.second + 1 - this->next_position : 0); }
+
+  protected:
+    const RLCSA& rlcsa;
+    pair_type    range;
+    usint        batch_size;
+    locate_type  strategy;
+    bool         steps;
+
+    usint        next_position;
+    usint        batch_start, batch_length;
+    usint*       buffer;
+
+    QueryContext context;
+
+    // These are not allowed.
+    LocateCursor();
+    LocateCursor(const LocateCursor&);
+    LocateCursor& operator = (const LocateCursor&);
+};
+
+
 class RLCSA
 {
   friend class RLCSABuilder;
+  friend class QueryContext;
+  friend class RunSamples;
+  friend class SampleCache;
 
   public:
 
@@ -61,7 +172,15 @@ class RLCSA
 
     static const usint ENDPOINT_BLOCK_SIZE = 16;
 
-    explicit RLCSA(const std::string& base_name, bool print = false);
+    /*
+      If memory_map is true, the Psi vectors, the end points, and the regular SA samples
+      point directly into memory-mapped files instead of being read into memory. The
+      files must not be modified while the index is in use.
+
+      Otherwise the Psi vectors, the end points, and the SA samples of a version 2 index
+      are read and indexed in parallel using the given number of threads.
+    */
+    explicit RLCSA(const std::string& base_name, bool print = false, bool memory_map = false, usint threads = 1);
 
     /*
       Build RLCSA for multiple sequences, treating each \0 as an end marker.
@@ -86,33 +205,180 @@ class RLCSA
     RLCSA(RLCSA& index, RLCSA& increment, usint* positions, usint block_size, usint threads = 1);
     ~RLCSA();
 
-    void writeTo(const std::string& base_name) const;
+    /*
+      Writes the index as separate files. If container is true, the parameters, the
+      Psi array, the SA samples, and the run samples are written as sections of a
+      single container file base_name + CONTAINER_EXTENSION instead. The container
+      is loaded instead of the separate files if it exists. Each file is written
+      under a temporary name and renamed over the old one, so the files can be
+      rewritten while another process has them memory mapped.
+    */
+    void writeTo(const std::string& base_name, bool container = false) const;
+
+    // Writes only the SA samples and the parameters, leaving the Psi array untouched.
+    void writeSamplesTo(const std::string& base_name) const;
 
     inline bool isOk() const { return this->ok; }
 
+    /*
+      The k-mer table is loaded with the index if the file exists and matches the
+      index. Searches for patterns of length at least k start from the range of a
+      k-mer in the table.
+      The RLCSA takes ownership of the table. Setting a table deletes the old one.
+    */
+    inline const KmerTable* getKmerTable() const { return this->kmer_table; }
+    void setKmerTable(KmerTable* table);
+
+    /*
+      Run samples are loaded with the index if the file exists and matches the
+      index. Unless steps are counted, locate(range) with LOCATE_RUNS, or with the
+      default strategy for long ranges, finds SA[range.first] and uses phi for the
+      rest of the range. Without the SA samples, locate(range) and locate(index)
+      still work with any strategy (see canLocate()). Then SA[range.first] is found
+      by following Psi to the next toehold, which may take many steps;
+      countWithToehold() and locateFromToehold() avoid this. Inverse locate,
+      display, and the other users of the SA samples require the SA samples.
+      The RLCSA takes ownership of the samples. Setting samples deletes the old ones.
+    */
+    inline const RunSamples* getRunSamples() const { return this->run_samples; }
+    void setRunSamples(RunSamples* samples);
+
+    /*
+      Replaces the SA samples. The samples must use the same text positions as the
+      index, and regular samples must use the sample rate of the index.
+      The RLCSA takes ownership of the samples.
+
+      When an index is loaded from disk, the SA samples are loaded when they are first
+      used. Loading is thread-safe. prefetch() loads them immediately, and asks the
+      kernel to read the memory-mapped files in the background.
+    */
+    inline const SASamples* getSASamples() const
+    {
+      if(__atomic_load_n(&(this->samples_pending), __ATOMIC_ACQUIRE)) { this->loadPendingSamples(); }
+      return this->sa_samples;
+    }
+    void setSASamples(SASamples* samples);
+    void prefetch() const;
+
+    /*
+      These build new SA samples for an existing index, replacing the old ones. The
+      sequences are traversed backward with LF from their end markers in parallel,
+      so the index does not need to support locate. Return false on failure.
+
+      Regular samples require each sequence to start at a multiple of the sample
+      rate. If the rate changes, the sequences are padded again, changing their
+      text positions, and the run samples are deleted. The index must then be
+      written with writeTo(), and the files depending on text positions must be
+      rebuilt.
+
+      Weighted samples are placed at the given text positions and at the start of
+      each sequence. Positions outside the sequences are ignored. The vector is
+      cleared.
+    */
+    bool buildSASamples(usint sample_rate, usint threads);
+    bool buildSASamples(std::vector<usint>& positions, usint threads);
+
 //--------------------------------------------------------------------------
 //  QUERIES
 //--------------------------------------------------------------------------
 
     // These queries use SA ranges.
+    // The versions taking a QueryContext do not construct Psi iterators.
 
     // Returns the closed range containing the matches.
     pair_type count(const std::string& pattern) const;
+    pair_type count(const std::string& pattern, QueryContext& context) const;
+
+    // Returns the SA range and sets toehold = SA[range.first]. Requires run samples.
+    // Returns EMPTY_PAIR without run samples.
+    pair_type countWithToehold(const std::string& pattern, usint& toehold) const;
 
     // Used when merging CSAs.
     void reportPositions(uchar* data, usint length, usint* positions) const;
 
     // Returns SA[range]. User must free the buffer. Latter version uses buffer provided by the user.
-    // Direct locate means locating one position at a time.
     // Steps means that the returned values are the number of Psi steps taken, not SA values.
-    usint* locate(pair_type range, bool direct = false, bool steps = false) const;
-    usint* locate(pair_type range, usint* data, bool direct = false, bool steps = false) const;
+    usint* locate(pair_type range, locate_type strategy = LOCATE_ADAPTIVE, bool steps = false) const;
+    usint* locate(pair_type range, usint* data, locate_type strategy = LOCATE_ADAPTIVE, bool steps = false) const;
+    usint* locate(pair_type range, QueryContext& context, locate_type strategy = LOCATE_ADAPTIVE, bool steps = false) const;
+    usint* locate(pair_type range, usint* data, QueryContext& context, locate_type strategy = LOCATE_ADAPTIVE, bool steps = false) const;
+
+    // Direct locate means locating one position at a time. Otherwise the range is
+    // located as runs.
+    inline usint* locate(pair_type range, bool direct, bool steps = false) const
+    {
+      return this->locate(range, toLocateType(direct), steps);
+    }
+    inline usint* locate(pair_type range, usint* data, bool direct, bool steps = false) const
+    {
+      return this->locate(range, data, toLocateType(direct), steps);
+    }
+    inline usint* locate(pair_type range, QueryContext& context, bool direct, bool steps = false) const
+    {
+      return this->locate(range, context, toLocateType(direct), steps);
+    }
+    inline usint* locate(pair_type range, usint* data, QueryContext& context, bool direct, bool steps = false) const
+    {
+      return this->locate(range, data, context, toLocateType(direct), steps);
+    }
+
+    // Multi-threaded locate. The range is split into chunks of at least PARALLEL_LOCATE_CHUNK
+    // positions, and each thread uses its own iterators. Ranges shorter than
+    // PARALLEL_LOCATE_THRESHOLD are located in the calling thread.
+    const static usint PARALLEL_LOCATE_THRESHOLD = 65536;
+    const static usint PARALLEL_LOCATE_CHUNK = 16384;
+    usint* parallelLocate(pair_type range, usint threads, locate_type strategy = LOCATE_ADAPTIVE, bool steps = false) const;
+    usint* parallelLocate(pair_type range, usint* data, usint threads, locate_type strategy = LOCATE_ADAPTIVE, bool steps = false) const;
+
+    inline usint* parallelLocate(pair_type range, usint threads, bool direct, bool steps = false) const
+    {
+      return this->parallelLocate(range, threads, toLocateType(direct), steps);
+    }
+    inline usint* parallelLocate(pair_type range, usint* data, usint threads, bool direct, bool steps = false) const
+    {
+      return this->parallelLocate(range, data, threads, toLocateType(direct), steps);
+    }
+
+    /*
+      Adaptive locate uses direct locate for ranges shorter than ADAPTIVE_LOCATE_MIN_RANGE,
+      as run-based locate must allocate and scan its own arrays in every round.
+      Longer ranges are split into segments by the length of the Psi runs starting
+      at each position. Run-based locate is used for segments where the runs are at
+      least getLocateRunLength() positions long, and direct locate for the rest.
+
+      With sample rate d, direct locate takes about d / 2 Psi steps per position.
+      Run-based locate takes up to d rounds, each of them scanning the positions and
+      taking one Psi step per run. With runs of length l, it is faster when
+      1 / l + (scan cost / Psi cost) < 1 / 2. The run length can be calibrated for
+      each index with parameter LOCATE_RUN_LENGTH. If run samples are present,
+      adaptive locate always uses them.
+    */
+    const static usint ADAPTIVE_LOCATE_MIN_RANGE = 8;
+    inline usint getLocateRunLength() const { return this->locate_run_length; }
+    inline void setLocateRunLength(usint run_length) { this->locate_run_length = std::max(run_length, (usint)1); }
+
+    // Returns SA[range], given toehold = SA[range.first] from countWithToehold().
+    // Uses phi from the run samples instead of Psi. User must free the buffer.
+    usint* locateFromToehold(pair_type range, usint toehold) const;
+    usint* locateFromToehold(pair_type range, usint toehold, usint* data) const;
 
     // Returns SA[index].
     usint locate(usint index, bool steps = false) const;
+    usint locate(usint index, QueryContext& context, bool steps = false) const;
     
     // Given SA[index], returns index.
     usint inverseLocate(usint location) const;
+    usint inverseLocate(usint location, QueryContext& context) const;
+
+    /*
+      Returns the indexes for the given SA values in the same order. The values are
+      sorted, and the Psi walk from a sample continues from one value to the next,
+      so the values sharing a sample are found in a single walk. Batches of at least
+      PARALLEL_LOCATE_THRESHOLD values are split between the threads. Values outside
+      the text get index getSize(). User must free the buffer.
+    */
+    usint* inverseLocate(const usint* locations, usint number, usint threads = 1) const;
+    usint* inverseLocate(const usint* locations, usint number, usint* data, usint threads = 1) const;
 
     // Returns T^{sequence}[range]. User must free the buffer.
     // Third version uses buffer provided by the user.
@@ -120,6 +386,15 @@ class RLCSA
     uchar* display(usint sequence, pair_type range) const;
     uchar* display(usint sequence, pair_type range, uchar* data) const;
 
+    // Multi-threaded display. The range is split into one chunk per thread, starting at sample
+    // boundaries, so each chunk is decoded from its own samples. The chunks have at least
+    // PARALLEL_DISPLAY_CHUNK characters.
+    // Ranges shorter than PARALLEL_DISPLAY_THRESHOLD are displayed in the calling thread.
+    const static usint PARALLEL_DISPLAY_THRESHOLD = 1048576;
+    const static usint PARALLEL_DISPLAY_CHUNK = 262144;
+    uchar* parallelDisplay(usint sequence, usint threads, bool include_end_marker = false) const;
+    uchar* parallelDisplay(usint sequence, pair_type range, uchar* data, usint threads) const;
+
     // Displays the intersection of T[position - context, position + len + context - 1]
     // and T^{getSequenceForPosition(position)}.
     // This is intended for displaying an occurrence of a pattern of length 'len'
@@ -133,19 +408,38 @@ class RLCSA
     // Returns at most max_len characters starting from T[SA[index]].
     // User must provide the buffer. Returns the number of characters in buffer.
     usint displayFromPosition(usint index, usint max_len, uchar* data) const;
+    usint displayFromPosition(usint index, usint max_len, uchar* data, QueryContext& context) const;
 
     // Get the range of SA values for the sequence identified by
     // a sequence number or a SA value.
     pair_type getSequenceRange(usint number) const;
     pair_type getSequenceRangeForPosition(usint value) const;
 
+    /*
+      The batch versions of getSequenceForPosition() and getRelativePosition() convert
+      sorted batches in a single scan over the end points, taking one step for each
+      sequence boundary between consecutive values and jumping with valueAfter() over
+      the rest. Unsorted batches of at least SORTED_CONVERSION_THRESHOLD values in
+      indexes with at least as many sequences are sorted first if relative positions are
+      requested or if there are at least SORTED_CONVERSION_SEQUENCES sequences. Otherwise
+      the values are converted one at a time. Batches of at least
+      PARALLEL_CONVERSION_THRESHOLD values are split between the threads. The results
+      are in the original order.
+    */
+    const static usint SORTED_CONVERSION_THRESHOLD = 1024;
+    const static usint SORTED_CONVERSION_SEQUENCES = 524288;
+    const static usint PARALLEL_CONVERSION_THRESHOLD = 65536;
+
     // Get the sequence number for given SA value(s).
     // The returned array is the same as the parameter.
     usint getSequenceForPosition(usint value) const;
-    usint* getSequenceForPosition(usint* value, usint length) const;
+    usint* getSequenceForPosition(usint* value, usint length, usint threads = 1) const;
 
     // Changes SA value to (sequence, offset).
     pair_type getRelativePosition(usint value) const;
+    // Changes SA values to (sequence, offset). User must free the buffer.
+    pair_type* getRelativePosition(const usint* values, usint length, usint threads = 1) const;
+
     // Changes (sequence, offset) to SA value (not the same as SA index; it's a
     // position in the unified coordinate space over all texts).
     usint getAbsolutePosition(pair_type position) const;
@@ -177,6 +471,16 @@ class RLCSA
       return this->psiUnsafe(sa_index, c);
     }
 
+    inline usint psi(usint sa_index, QueryContext& context) const
+    {
+      if(sa_index >= this->data_size)
+      {
+        return this->data_size + this->number_of_sequences;
+      }
+
+      return this->psi(sa_index, context.iters);
+    }
+
     // This version returns a run.
     inline pair_type psi(usint sa_index, usint max_length) const
     {
@@ -207,6 +511,22 @@ class RLCSA
       return this->LF(sa_index, c, iter);
     }
 
+    inline usint LF(usint sa_index, usint c, QueryContext& context) const
+    {
+      if(c >= CHARS)
+      {
+        return this->data_size + this->number_of_sequences;
+      }
+      if(this->array[c] == 0)
+      {
+        if(c < this->alphabet->getFirstChar()) { return this->number_of_sequences - 1; }
+        return this->alphabet->cumulative(c) + this->number_of_sequences - 1;
+      }
+      this->convertToBWTIndex(sa_index);
+
+      return this->LF(sa_index, c, *(context.iters[c]));
+    }
+
     inline void convertToSAIndex(usint& bwt_index) const { bwt_index -= this->number_of_sequences; }
     inline void convertToBWTIndex(usint& sa_index) const { sa_index += this->number_of_sequences; }
 
@@ -241,6 +561,7 @@ class RLCSA
 
     // This is an unsafe function that does not check its parameters.
     pair_type LF(pair_type bwt_range, usint c) const;
+    pair_type LF(pair_type bwt_range, usint c, QueryContext& context) const;
 
     // User must free the returned vector.
     std::vector<usint>* locateRange(pair_type range) const;
@@ -250,12 +571,35 @@ class RLCSA
 //  REPORTING
 //--------------------------------------------------------------------------
 
-    inline bool supportsLocate() const { return this->support_locate; }
-    inline bool supportsDisplay() const { return this->support_display; }
+    // These load pending SA samples. If loading fails, the index supports neither.
+    inline bool supportsLocate() const
+    {
+      if(__atomic_load_n(&(this->samples_pending), __ATOMIC_ACQUIRE)) { this->loadPendingSamples(); }
+      return this->support_locate;
+    }
+    inline bool supportsDisplay() const
+    {
+      if(__atomic_load_n(&(this->samples_pending), __ATOMIC_ACQUIRE)) { this->loadPendingSamples(); }
+      return this->support_display;
+    }
+    inline bool supportsToeholdLocate() const { return (this->run_samples != 0); }
+
+    // locate(range) and locate(index) work with the SA samples or the run samples.
+    inline bool canLocate() const { return (this->supportsLocate() || this->supportsToeholdLocate()); }
     inline usint getSize() const { return this->data_size; }
     inline usint getTextSize() const { return this->end_points->getSize(); }
     inline usint getNumberOfSequences() const { return this->number_of_sequences; }
+    inline usint getSampleRate() const { return this->sample_rate; }
     inline usint getBlockSize() const { return this->array[this->alphabet->getFirstChar()]->getBlockSize(); }
+    usint getPsiEncoding() const;  // Returns PsiVector::MIXED if the encodings differ.
+
+    /*
+      Data size, text size, number of sequences, and a hash of the end points, the
+      character counts, and the encoded Psi vectors. K-mer tables and run samples use
+      this to detect files built for another index. Re-encoding the Psi vectors also
+      changes the identity. Computing it reads the entire Psi array.
+    */
+    std::vector<usint> getIdentity() const;
 
     // Returns the size of the data structure.
     usint reportSize(bool print = false) const;
@@ -305,6 +649,24 @@ class RLCSA
     usint number_of_sequences;
     DeltaVector* end_points;
 
+    KmerTable* kmer_table;
+    RunSamples* run_samples;
+
+    usint locate_run_length;
+
+    // Memory-mapped files the structures point to, or 0.
+    FileMap* array_map;
+    FileMap* sample_map;
+
+    // SA samples to be loaded on first use.
+    mutable bool samples_pending;
+    std::string  samples_name;
+    Parameters   samples_parameters;
+    bool         samples_mapped;
+    #ifdef MULTITHREAD_SUPPORT
+    mutable omp_lock_t samples_lock;
+    #endif
+
 //--------------------------------------------------------------------------
 //  INTERNAL VERSIONS OF QUERIES
 //--------------------------------------------------------------------------
@@ -312,19 +674,46 @@ class RLCSA
     // Locates the given SA range, one item at a time, storing results in the
     // array given by the data pointer. Finds actual locations if steps is
     // false, or the number of steps needed to determine each location if steps
-    // is true.
-    void  directLocate(pair_type range, usint* data, bool steps) const;
+    // is true. If context is 0, iterators are constructed as needed.
+    void  directLocate(pair_type range, usint* data, bool steps, QueryContext* context) const;
     // Locates the given BWT position, returning either the actual location or
     // the steps needed to find it, depending on the value of steps.
-    usint directLocate(usint index, bool steps) const;
-    void  locateUnsafe(pair_type range, usint* data, bool steps) const;
+    usint directLocate(usint index, bool steps, QueryContext* context) const;
+    void  locateUnsafe(pair_type range, usint* data, bool steps, QueryContext& context) const;
+    void  adaptiveLocate(pair_type range, usint* data, bool steps, QueryContext& context) const;
+    void  locateWithStrategy(pair_type range, usint* data, locate_type strategy, bool steps, QueryContext& context) const;
+    inline static locate_type toLocateType(bool direct) { return (direct ? LOCATE_DIRECT : LOCATE_RUNS); }
     bool  processRun(pair_type run, usint* data, usint* offsets, bool* finished, PsiVector::Iterator** iters, bool steps) const;
     void  displayUnsafe(pair_type range, uchar* data, bool get_ranks = false, usint* ranks = 0) const;
+    void  parallelDisplayUnsafe(pair_type range, uchar* data, usint threads) const;
+
+    // Batch conversion of SA values. Either output can be 0, and sequences can be the
+    // same array as values.
+    void  convertPositions(const usint* values, usint len, usint* sequences, pair_type* relative, usint threads) const;
+    void  convertChunks(const usint* values, usint len, usint* sequences, pair_type* relative, bool sorted, usint threads) const;
+    void  scanSortedPositions(const usint* values, usint len, usint* sequences, pair_type* relative) const;
+    void  searchPositions(const usint* values, usint len, usint* sequences, pair_type* relative) const;
+
+    /*
+      Displays the range by walking from all regular samples in it at the same time.
+      The walkers are kept in SA order, and one selectRun() is enough for all walkers
+      in the same run of Psi. Walkers at the same offset in different copies of a
+      repeat are in the same runs. Ranges of at least DISPLAY_RUN_THRESHOLD sample
+      intervals are displayed in this way.
+    */
+    const static usint DISPLAY_RUN_THRESHOLD = 4;
+    void  displayRuns(pair_type range, uchar* data, bool get_ranks, usint* ranks, QueryContext& context) const;
 
     void locateRange(pair_type range, std::vector<usint>& vec) const;
     
     // Given a sequence position, return the corresponding BWT position.
-    usint directInverseLocate(usint location) const;
+    usint directInverseLocate(usint location, QueryContext* context) const;
+
+    // Inverse locates order[i].first into data[order[i].second] for the sorted order.
+    void inverseLocateSorted(const pair_type* order, usint number, usint* data, QueryContext& context) const;
+
+    pair_type count(const std::string& pattern, QueryContext* context) const;
+    usint displayFromPosition(usint index, usint max_len, uchar* data, QueryContext* context) const;
 
 //--------------------------------------------------------------------------
 //  INTERNAL VERSIONS OF BASIC OPERATIONS
@@ -370,10 +759,6 @@ class RLCSA
 //  INTERNAL STUFF
 //--------------------------------------------------------------------------
 
-    // Creates an array of iterators for every vector in this->array.
-    PsiVector::Iterator** getIterators() const;
-    void deleteIterators(PsiVector::Iterator** iters) const;
-
     void mergeEndPoints(RLCSA& index, RLCSA& increment);
     void mergeSamples(RLCSA& index, RLCSA& increment, usint* positions);
 
@@ -383,6 +768,25 @@ class RLCSA
     // Removes structures not necessary for merging.
     void strip();
 
+    /*
+      Traverses the sequence backward with LF from its end marker, and writes the
+      pairs (SA index, text position) for the given offsets into the output.
+      The offsets must be sorted and smaller than the length of the sequence.
+    */
+    void sampleSequence(usint number, const usint* offsets, usint count, pair_type* output, QueryContext& context) const;
+
+    // The table in the Psi array file: sample rate, offsets of Psi vectors, offset of end points.
+    const static usint ARRAY_TABLE_WORDS = CHARS + 2;
+
+    bool loadSASamples(const std::string& base_name, const Parameters& parameters, bool memory_map);
+    void initializeLazyLoading();
+    void loadPendingSamples() const;
+    bool loadParallel(const std::string& base_name, const Parameters& parameters, std::streampos array_start, const usint* offsets, usint threads);
+
+    void writeArrayTo(std::ofstream& array_file) const;
+    void writeSASamplesTo(std::ofstream& sa_sample_file) const;
+    Parameters getParameters() const;
+
     // These are not allowed.
     RLCSA();
     RLCSA(const RLCSA&);
@@ -96,7 +96,7 @@ RLCSABuilder::insertFromFile(const std::string& base_name)
 
   std::ifstream input(base_name.c_str(), std::ios_base::binary);
   if(!input) { return; }
-  RLCSA* increment = new RLCSA(base_name);
+  RLCSA* increment = new RLCSA(base_name, false, false, this->threads);
   usint data_size = increment->getSize() + increment->getNumberOfSequences();
   uchar* data = new uchar[data_size];
   input.read((char*)data, data_size);
@@ -116,7 +116,7 @@ RLCSABuilder::insertFromFile(const std::string& base_name, uchar* data)
 
   this->flush();
 
-  RLCSA* increment = new RLCSA(base_name);
+  RLCSA* increment = new RLCSA(base_name, false, false, this->threads);
   usint data_size = increment->getSize() + increment->getNumberOfSequences();
 
   this->addRLCSA(increment, data, data_size, false);
@@ -0,0 +1,152 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "queryserver.h"
+
+
+using namespace CSA;
+
+
+/*
+  This program sends the queries read from stdin to rlcsa_server in batches, and
+  writes one line of results for each query to stdout. The queries are patterns, one
+  per line, or lines "sequence first last" for display. With -r, it asks the server
+  to reload the index, optionally from a new base name, and does not read stdin.
+*/
+
+
+enum mode_type { COUNT, LOCATE, DISPLAY, MAP };
+
+const usint DEFAULT_BATCH_SIZE = 1024;
+
+
+void printUsage()
+{
+  std::cout << "Usage: rlcsa_client [-c|-l|-d|-m] socket_name index [batch_size] < queries" << std::endl;
+  std::cout << "       rlcsa_client -r socket_name index [base_name]" << std::endl;
+  std::cout << "  -c    print the number of occurrences of each pattern (default)" << std::endl;
+  std::cout << "  -l    print the start positions of the occurrences" << std::endl;
+  std::cout << "  -d    display the given ranges of the given sequences" << std::endl;
+  std::cout << "  -m    map each base of the pattern and print (text, position) or -" << std::endl;
+  std::cout << "  -r    reload the index and swap the new version in" << std::endl;
+}
+
+bool
+runBatch(QueryClient& client, mode_type mode, usint index, const std::vector<std::string>& queries)
+{
+  usint status = QueryServer::OK;
+  if(mode == COUNT)
+  {
+    std::vector<pair_type> results;
+    status = client.count(index, queries, results);
+    for(usint i = 0; i < results.size(); i++) { std::cout << length(results[i]) << std::endl; }
+  }
+  else if(mode == LOCATE)
+  {
+    std::vector<std::vector<usint> > results;
+    status = client.locate(index, queries, results);
+    for(usint i = 0; i < results.size(); i++)
+    {
+      for(usint j = 0; j < results[i].size(); j++) { std::cout << (j > 0 ? " " : "") << results[i][j]; }
+      std::cout << std::endl;
+    }
+  }
+  else if(mode == DISPLAY)
+  {
+    std::vector<QueryClient::display_type> ranges;
+    for(usint i = 0; i < queries.size(); i++)
+    {
+      std::istringstream stream(queries[i]);
+      usint sequence = 0, first = 1, last = 0;
+      stream >> sequence >> first >> last;
+      ranges.push_back(QueryClient::display_type(sequence, pair_type(first, last)));
+    }
+    std::vector<std::string> results;
+    status = client.display(index, ranges, results);
+    for(usint i = 0; i < results.size(); i++) { std::cout << results[i] << std::endl; }
+  }
+  else
+  {
+    std::vector<std::vector<pair_type> > results;
+    status = client.map(index, queries, results);
+    for(usint i = 0; i < results.size(); i++)
+    {
+      for(usint j = 0; j < results[i].size(); j++)
+      {
+        if(j > 0) { std::cout << " "; }
+        if(results[i][j].first == QueryServer::NOT_MAPPED) { std::cout << "-"; }
+        else { std::cout << results[i][j].first << "," << results[i][j].second; }
+      }
+      std::cout << std::endl;
+    }
+  }
+
+  if(status != QueryServer::OK)
+  {
+    std::cerr << "Error: Query failed with status " << status << "!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+int
+main(int argc, char** argv)
+{
+  int arg = 1;
+  mode_type mode = COUNT;
+  bool reload = false;
+  if(argc > arg && argv[arg][0] == '-')
+  {
+    std::string option = argv[arg];
+    if(option == "-c")      { mode = COUNT; }
+    else if(option == "-l") { mode = LOCATE; }
+    else if(option == "-d") { mode = DISPLAY; }
+    else if(option == "-m") { mode = MAP; }
+    else if(option == "-r") { reload = true; }
+    else
+    {
+      printUsage();
+      return 1;
+    }
+    arg++;
+  }
+  if(argc < arg + 2)
+  {
+    printUsage();
+    return 1;
+  }
+
+  QueryClient client(argv[arg]);
+  if(!(client.isOk())) { return 2; }
+  usint index = atoi(argv[arg + 1]);
+  if(reload)
+  {
+    usint status = client.reload(index, (argc > arg + 2 ? argv[arg + 2] : ""));
+    if(status != QueryServer::OK)
+    {
+      std::cerr << "Error: Reload failed with status " << status << "!" << std::endl;
+      return 3;
+    }
+    return 0;
+  }
+  usint batch_size = DEFAULT_BATCH_SIZE;
+  if(argc > arg + 2) { batch_size = std::max(atoi(argv[arg + 2]), 1); }
+
+  std::vector<std::string> queries;
+  std::string line;
+  while(std::getline(std::cin, line))
+  {
+    queries.push_back(line);
+    if(queries.size() >= batch_size)
+    {
+      if(!runBatch(client, mode, index, queries)) { return 3; }
+      queries.clear();
+    }
+  }
+  if(!queries.empty() && !runBatch(client, mode, index, queries)) { return 3; }
+
+  return 0;
+}
@@ -1,155 +1,345 @@
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
+#include "container.h"
+#include "docarray.h"
 #include "rlcsa.h"
 #include "misc/utils.h"
 
 using namespace CSA;
 
 
-enum mode_type { COUNT, TOTAL, START, RELATIVE, DISPLAY, CONTEXT };
+enum mode_type { COUNT, TOTAL, START, RELATIVE, SA_START, SA_RELATIVE, DISPLAY, CONTEXT };
+
+// Patterns processed before their output is written in batch mode.
+const usint PATTERN_BLOCK = 4096;
+
+// Sequence ids are deduplicated with a bitmap when there are at least
+// (number of sequences / BITMAP_THRESHOLD) of them, and by sorting otherwise.
+const usint BITMAP_THRESHOLD = 16;
 
 
 void printUsage()
 {
-  std::cout << "Usage: rlcsa_grep [-c|-t|-s|-r|-NUM] pattern base_name" << std::endl;
+  std::cout << "Usage: rlcsa_grep [-c|-t|-s|-r|-S|-R|-NUM] pattern base_name" << std::endl;
+  std::cout << "       rlcsa_grep [-c|-t|-s|-r|-S|-R|-NUM] -f|-p pattern_file base_name" << std::endl;
   std::cout << "  -c    print the number of matching sequences" << std::endl;
   std::cout << "  -t    print the total number of occurrences" << std::endl;
   std::cout << "  -s    print the start positions of matches" << std::endl;
   std::cout << "  -r    print the relative start positions of matches (sequence, position)" << std::endl;
+  std::cout << "  -S|-R as -s|-r, but in suffix array order, located and printed in batches" << std::endl;
+  std::cout << "        without storing all occurrences" << std::endl;
   std::cout << "  -NUM  display NUM characters of leading and trailing context instead of" << std::endl;
   std::cout << "        the entire line" << std::endl;
+  std::cout << "  -f    read the patterns from a file, one per line" << std::endl;
+  std::cout << "  -p    read the patterns from a file in Pizza&Chili format" << std::endl;
+  std::cout << "With a pattern file, each line of output starts with the number of the pattern" << std::endl;
+  std::cout << "and a colon, and the patterns are processed in parallel." << std::endl;
+}
+
+
+/*
+  Replaces the sequence ids with the distinct ids in sorted order and returns their
+  number. Setting the bits and scanning the bitmap takes O(n + sequences / WORD_BITS)
+  time, so sorting is only used when there are few ids.
+*/
+usint
+distinctSequences(usint* ids, usint n, usint sequences)
+{
+  if(n == 0) { return 0; }
+  if(n < sequences / BITMAP_THRESHOLD)
+  {
+    std::sort(ids, ids + n);
+    return std::unique(ids, ids + n) - ids;
+  }
+
+  std::vector<usint> bitmap(BITS_TO_WORDS(sequences), 0);
+  for(usint i = 0; i < n; i++) { bitmap[ids[i] / WORD_BITS] |= (usint)1 << (ids[i] % WORD_BITS); }
+
+  usint distinct = 0;
+  for(usint i = 0; i < bitmap.size(); i++)
+  {
+    for(usint word = bitmap[i]; word != 0; word &= word - 1)
+    {
+      ids[distinct] = i * WORD_BITS + __builtin_ctzll(word); distinct++;
+    }
+  }
+  return distinct;
+}
+
+
+/*
+  Lists the distinct sequences containing the occurrences in sorted order. Each
+  sequence is listed only once, even if it matches multiple times.
+*/
+void
+listSequences(const RLCSA& rlcsa, const DocArray* docarray, pair_type range, usint threads,
+  std::vector<usint>& sequences)
+{
+  if(docarray != 0)
+  {
+    std::vector<usint>* documents = docarray->listDocuments(range);
+    if(documents != 0) { sequences.swap(*documents); }
+    delete documents;
+    return;
+  }
+
+  usint occurrences = length(range);
+  usint* results = rlcsa.parallelLocate(range, threads);
+  if(results == 0) { return; }
+  rlcsa.getSequenceForPosition(results, occurrences, threads);
+  usint distinct = distinctSequences(results, occurrences, rlcsa.getNumberOfSequences());
+  sequences.assign(results, results + distinct);
+  delete[] results;
+}
+
+
+// Writes the positions, or the relative positions if relative is true.
+void
+printPositions(const RLCSA& rlcsa, const usint* positions, usint n, bool relative,
+  const std::string& prefix, usint threads, std::ostream& output)
+{
+  if(!relative)
+  {
+    for(usint i = 0; i < n; i++) { output << prefix << positions[i] << '\n'; }
+    return;
+  }
+
+  pair_type* results = rlcsa.getRelativePosition(positions, n, threads);
+  for(usint i = 0; i < n; i++)
+  {
+    output << prefix << results[i].first << ", " << results[i].second << '\n';
+  }
+  delete[] results;
+}
+
+
+/*
+  Writes the results for the pattern to the stream. Each line starts with the prefix.
+  Multi-threaded locate uses the given number of threads. If there is a document
+  listing structure, it is used for listing the matching sequences.
+*/
+void
+grep(const RLCSA& rlcsa, const DocArray* docarray, const std::string& pattern, mode_type mode,
+  usint context, const std::string& prefix, usint threads, std::ostream& output)
+{
+  usint len = pattern.length();
+  pair_type result_range = rlcsa.count(pattern);
+  usint occurrences = length(result_range);
+
+  if(mode == TOTAL)
+  {
+    output << prefix << occurrences << '\n';
+    return;
+  }
+
+  if(occurrences == 0)
+  {
+    if(mode == COUNT)
+    {
+      output << prefix << 0 << '\n';
+    }
+    return;
+  }
+
+  if(mode == START || mode == RELATIVE)
+  {
+    usint* results = rlcsa.parallelLocate(result_range, threads);
+    if(results == 0) { return; }
+    std::sort(results, results + occurrences);
+    printPositions(rlcsa, results, occurrences, (mode == RELATIVE), prefix, threads, output);
+    delete[] results;
+    return;
+  }
+
+  // Positions in suffix array order are streamed in batches to bound the memory usage.
+  if(mode == SA_START || mode == SA_RELATIVE)
+  {
+    LocateCursor cursor(rlcsa, result_range);
+    while(cursor.next() > 0)
+    {
+      printPositions(rlcsa, cursor.getBatch(), cursor.getBatchLength(), (mode == SA_RELATIVE), prefix, threads, output);
+    }
+    return;
+  }
+
+  if(mode == COUNT || mode == DISPLAY)
+  {
+    std::vector<usint> sequences;
+    listSequences(rlcsa, docarray, result_range, threads, sequences);
+    if(mode == COUNT)
+    {
+      output << prefix << sequences.size() << '\n';
+      return;
+    }
+    for(usint i = 0; i < sequences.size(); i++)
+    {
+      uchar* row = rlcsa.display(sequences[i]);
+      output << prefix;
+      output.write((char*)row, length(rlcsa.getSequenceRange(sequences[i])));
+      output << '\n';
+      delete[] row;
+    }
+    return;
+  }
+
+  // Context mode displays the occurrences in text order.
+  usint* results = rlcsa.parallelLocate(result_range, threads);
+  std::sort(results, results + occurrences);
+  usint result_length = 0;
+  for(usint i = 0; i < occurrences; i++)
+  {
+    uchar* text = rlcsa.display(results[i], len, context, result_length);
+    output << prefix;
+    output.write((char*)text, result_length);
+    output << '\n';
+    delete[] text;
+  }
+  delete[] results;
+}
+
+
+/*
+  The patterns are processed in blocks. Each pattern in a block is processed by one
+  thread into its own buffer, and the buffers are written in pattern order.
+*/
+void
+grepBatch(const RLCSA& rlcsa, const DocArray* docarray, const std::vector<std::string>& patterns,
+  mode_type mode, usint context)
+{
+  usint threads = maxThreads();
+  std::vector<std::string> buffers(std::min(PATTERN_BLOCK, (usint)(patterns.size())));
+
+  for(usint block = 0; block < patterns.size(); block += PATTERN_BLOCK)
+  {
+    usint block_size = std::min(PATTERN_BLOCK, (usint)(patterns.size()) - block);
+    #ifdef MULTITHREAD_SUPPORT
+    omp_set_num_threads(threads);
+    #endif
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(sint i = 0; i < (sint)block_size; i++)
+    {
+      std::ostringstream prefix; prefix << (block + i + 1) << ":";
+      std::ostringstream output;
+      grep(rlcsa, docarray, patterns[block + i], mode, context, prefix.str(), 1, output);
+      buffers[i] = output.str();
+    }
+
+    for(usint i = 0; i < block_size; i++)
+    {
+      std::cout.write(buffers[i].data(), buffers[i].length());
+      buffers[i].clear();
+    }
+  }
+  std::cout.flush();
 }
 
 
 int main(int argc, char** argv)
 {
-  int base_arg = 2, pattern_arg = 1;
   mode_type mode = DISPLAY;
   usint context = 0;
+  int arg = 1;
 
-  if(argc < base_arg + 1)
+  if(argc < arg + 2)
   {
     printUsage();
     return 1;
   }
 
-  if(argv[1][0] == '-')
+  std::string option = argv[arg];
+  if(option[0] == '-' && option != "-f" && option != "-p")
   {
-    base_arg++; pattern_arg++;
-    if(std::string("-c").compare(argv[1]) == 0)
+    arg++;
+    if(option == "-c")
     {
       mode = COUNT;
     }
-    else if(std::string("-t").compare(argv[1]) == 0)
+    else if(option == "-t")
     {
       mode = TOTAL;
     }
-    else if(std::string("-s").compare(argv[1]) == 0)
+    else if(option == "-s")
     {
       mode = START;
     }
-    else if(std::string("-r").compare(argv[1]) == 0)
+    else if(option == "-r")
     {
       mode = RELATIVE;
     }
-    else
+    else if(option == "-S")
     {
-      mode = CONTEXT;
-      context = atoi(&(argv[1][1]));
+      mode = SA_START;
     }
-    if(argc < base_arg + 1)
+    else if(option == "-R")
     {
-      printUsage();
-      return 2;
+      mode = SA_RELATIVE;
+    }
+    else
+    {
+      mode = CONTEXT;
+      context = atoi(option.c_str() + 1);
     }
   }
 
-  RLCSA rlcsa(argv[base_arg], false);
-  if(!rlcsa.isOk())
+  bool batch = false, pizza = false;
+  if(argc > arg && (std::string("-f") == argv[arg] || std::string("-p") == argv[arg]))
   {
-    return 3;
+    batch = true; pizza = (std::string("-p") == argv[arg]);
+    arg++;
   }
-
-  usint len = std::string(argv[pattern_arg]).length();
-  pair_type result_range = rlcsa.count(argv[pattern_arg]);
-  usint occurrences = length(result_range);
-  
-  if(mode == TOTAL)
+  if(argc != arg + 2)
   {
-    std::cout << occurrences << std::endl;
-    return 0;
+    printUsage();
+    return 2;
   }
-  
-  if(occurrences == 0)
+
+  std::vector<std::string> patterns;
+  if(batch)
   {
-    if(mode == COUNT)
+    std::ifstream pattern_file(argv[arg], std::ios_base::binary);
+    if(!pattern_file)
     {
-      std::cout << 0 << std::endl;
+      std::cerr << "Error opening pattern file!" << std::endl;
+      return 4;
     }
-    return 0;
+    if(!pizza) { readRows(pattern_file, patterns, true); }
+    else       { readPizzaChili(pattern_file, patterns); }
+    pattern_file.close();
   }
 
-  usint last_row = 0;
-  usint* results = rlcsa.locate(result_range);
-  if(mode == COUNT || mode == DISPLAY)
+  RLCSA rlcsa(argv[arg + 1], false, true);
+  if(!rlcsa.isOk())
   {
-    // Make results hold text numbers instead of positions.
-    rlcsa.getSequenceForPosition(results, occurrences);
+    return 3;
   }
-  std::sort(results, results + occurrences);
+
+  // Use the document listing structure if it exists and has the grammar.
+  DocArray* docarray = 0;
   if(mode == COUNT || mode == DISPLAY)
   {
-    // Find each text only once, even if it matches multiple times.
-    for(usint i = 1; i < occurrences; i++)
+    std::ifstream document_file;
+    if(openIndexFile(argv[arg + 1], DOCUMENT_EXTENSION, document_file))
     {
-      if(results[i] != results[last_row])
-      {
-        last_row++; results[last_row] = results[i];
-      }
+      document_file.close();
+      docarray = new DocArray(rlcsa, argv[arg + 1]);
+      if(!(docarray->isOk()) || !(docarray->hasGrammar())) { delete docarray; docarray = 0; }
     }
   }
 
-  if(mode == COUNT)
-  {
-    std::cout << (last_row + 1) << std::endl;
-  }
-  else if(mode == DISPLAY)
+  if(batch)
   {
-    for(usint i = 0; i <= last_row; i++)
-    {
-      uchar* row = rlcsa.display(results[i]);
-      std::cout.write((char*)row, length(rlcsa.getSequenceRange(results[i])));
-      std::cout << std::endl;
-      delete[] row;
-    }
+    grepBatch(rlcsa, docarray, patterns, mode, context);
   }
-  else if(mode == START)
+  else
   {
-    for(usint i = 0; i < occurrences; i++)
-    {
-      std::cout << results[i] << std::endl;
-    }
-  }
-  else if(mode == RELATIVE)
-  {
-    for(usint i = 0; i < occurrences; i++)
-    {
-      pair_type relative = rlcsa.getRelativePosition(results[i]);
-      std::cout << relative.first << ", " << relative.second << std::endl;
-    }
-  }
-  else if(mode == CONTEXT)
-  {
-    usint result_length = 0;
-    for(usint i = 0; i < occurrences; i++)
-    {
-      uchar* text = rlcsa.display(results[i], len, context, result_length);
-      std::cout.write((char*)text, result_length);
-      std::cout << std::endl;
-      delete[] text;
-    }
+    grep(rlcsa, docarray, argv[arg], mode, context, "", maxThreads(), std::cout);
+    std::cout.flush();
   }
 
-  delete[] results;
+  delete docarray;
+
   return 0;
 }
@@ -0,0 +1,93 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "queryserver.h"
+#include "misc/utils.h"
+
+
+using namespace CSA;
+
+
+/*
+  This program loads the indexes once and serves batched count, locate, display, and
+  map queries over a Unix domain socket until it receives SIGINT or SIGTERM. The
+  indexes are memory mapped and prefetched. SIGHUP reloads all indexes in the
+  background and swaps the new versions in. See queryserver.h for the protocol and
+  rlcsa_client for a command line client.
+*/
+
+
+const int MAX_THREADS = 64;
+
+QueryServer* server = 0;
+
+void
+stopServer(int signal)
+{
+  if(server != 0) { server->stop(); }
+}
+
+void
+reloadIndexes(int signal)
+{
+  if(server != 0) { server->reloadAll(); }
+}
+
+
+int
+main(int argc, char** argv)
+{
+  std::cout << "RLCSA query server" << std::endl;
+  if(argc < 3)
+  {
+    std::cout << "Usage: rlcsa_server [-threads] socket_name base_name [base_name2 ...]" << std::endl;
+    return 1;
+  }
+
+  int arg = 1;
+  usint threads = 1;
+  if(argv[arg][0] == '-')
+  {
+    threads = std::min(MAX_THREADS, std::max(atoi(argv[arg] + 1), 1));
+    arg++;
+  }
+  if(argc < arg + 2)
+  {
+    std::cout << "Usage: rlcsa_server [-threads] socket_name base_name [base_name2 ...]" << std::endl;
+    return 1;
+  }
+  std::string socket_name = argv[arg]; arg++;
+  std::cout << "Socket: " << socket_name << std::endl;
+  std::cout << "Threads: " << threads << std::endl;
+  std::cout << std::endl;
+
+  double start = readTimer();
+  std::vector<std::string> base_names(argv + arg, argv + argc);
+  server = new QueryServer(base_names, threads);
+  if(!(server->isOk()))
+  {
+    delete server;
+    return 2;
+  }
+  for(usint i = 0; i < base_names.size(); i++)
+  {
+    std::cout << "Index " << i << ": " << base_names[i] << std::endl;
+  }
+  std::cout << "Indexes loaded in " << (readTimer() - start) << " seconds" << std::endl;
+  std::cout << std::endl;
+
+  signal(SIGINT, stopServer);
+  signal(SIGTERM, stopServer);
+  signal(SIGHUP, reloadIndexes);
+  bool ok = server->serve(socket_name);
+  QueryServer* stopped = server; server = 0;
+  delete stopped;
+
+  std::cout << "Server stopped" << std::endl;
+  std::cout << "Memory usage: " << memoryUsage() << " kB" << std::endl;
+  std::cout << std::endl;
+
+  return (ok ? 0 : 3);
+}
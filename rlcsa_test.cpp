@@ -5,6 +5,7 @@
 
 #include "rlcsa.h"
 #include "adaptive_samples.h"
+#include "samplecache.h"
 #include "suffixarray.h"
 #include "docarray.h"
 
@@ -75,7 +76,7 @@ int main(int argc, char** argv)
   std::cout << "RLCSA test" << std::endl;
   std::cout << std::endl;
 
-  bool adaptive = false, direct = false, locate = false, pizza = false, count_steps = false;
+  bool adaptive = false, cache = false, direct = false, runs = false, locate = false, pizza = false, count_steps = false;
   bool use_sa = false;
   bool listing = false, rle = false;
   usint ignore = 0, generate = 0;
@@ -94,6 +95,8 @@ int main(int argc, char** argv)
       {
         case 'a':
           adaptive = true; break;
+        case 'C':
+          cache = true; break;
         case 'd':
           direct = true; break;
         case 'g':
@@ -112,6 +115,8 @@ int main(int argc, char** argv)
           pizza = true; break;
         case 'r':
           rle = true; break;
+        case 'R':
+          runs = true; break;
         case 'S':
           use_sa = true; break;
         case 's':
@@ -147,10 +152,10 @@ int main(int argc, char** argv)
   if(generate > 0) { std::cout << " generate=" << generate; }
   if(ignore_tab) { std::cout << " ignore=tab"; }
   else if(ignore > 0) { std::cout << " ignore=" << ignore; }
-  if(use_sa) { adaptive = direct = count_steps = listing = false; }
+  if(use_sa) { adaptive = cache = direct = runs = count_steps = listing = false; }
   if(listing)
   {
-    locate = adaptive = count_steps = write = false;
+    locate = adaptive = cache = count_steps = write = false;
     std::cout << " listing";
     if(direct || rle)
     {
@@ -165,16 +170,18 @@ int main(int argc, char** argv)
   {
     rle = sort_patterns = false;
     std::cout << " locate";
-    if(adaptive || direct || count_steps)
+    if(adaptive || cache || direct || runs || count_steps)
     {
       std::cout << "(";
-      if(adaptive)    { std::cout << " adaptive"; direct = true; }
-      if(direct)      { std::cout << " direct"; }
+      if(adaptive)    { std::cout << " adaptive"; direct = true; cache = false; }
+      if(cache)       { std::cout << " cache"; direct = runs = false; }
+      if(direct)      { std::cout << " direct"; runs = false; }
+      if(runs)        { std::cout << " runs"; }
       if(count_steps) { std::cout << " steps"; write = false; }
       std::cout << " )";
     }
   }
-  else { adaptive = direct = count_steps = write = rle = sort_patterns = false; }
+  else { adaptive = cache = direct = runs = count_steps = write = rle = sort_patterns = false; }
   if(sort_patterns) { std::cout << " sort_patterns"; }
   if(pizza) { std::cout << " pizza"; }
   if(use_sa) { std::cout << " sa"; }
@@ -189,7 +196,7 @@ int main(int argc, char** argv)
   std::cout << std::endl;
 
 
-  const RLCSA* rlcsa = (use_sa ? 0 : new RLCSA(base_name, false));
+  const RLCSA* rlcsa = (use_sa ? 0 : new RLCSA(base_name, false, false, threads));
   const SuffixArray* sa = (use_sa ? new SuffixArray(base_name, false) : 0);
   usint size = 0, text_size = 0;
   if(use_sa)
@@ -238,6 +245,20 @@ int main(int argc, char** argv)
     }
   }
 
+  SampleCache* sample_cache = 0;
+  if(cache)
+  {
+    sample_cache = new SampleCache(*rlcsa, base_name);
+    sample_cache->report();
+    if(!sample_cache->isOk())
+    {
+      delete rlcsa; rlcsa = 0;
+      delete sa; sa = 0;
+      delete sample_cache; sample_cache = 0;
+      return 4;
+    }
+  }
+
   DocArray* docarray = 0;
   if(listing)
   {
@@ -254,6 +275,7 @@ int main(int argc, char** argv)
         delete rlcsa; rlcsa = 0;
         delete sa; sa = 0;
         delete adaptive_samples; adaptive_samples = 0;
+        delete sample_cache; sample_cache = 0;
         delete docarray; docarray = 0;
         return 5;
       }
@@ -267,6 +289,7 @@ int main(int argc, char** argv)
     delete rlcsa; rlcsa = 0;
     delete sa; sa = 0;
     delete adaptive_samples; adaptive_samples = 0;
+    delete sample_cache; sample_cache = 0;
     return 6;
   }
   std::vector<std::string> rows;
@@ -279,6 +302,7 @@ int main(int argc, char** argv)
     delete rlcsa; rlcsa = 0;
     delete sa; sa = 0;
     delete adaptive_samples; adaptive_samples = 0;
+    delete sample_cache; sample_cache = 0;
     return 7;
   }
   std::vector<Pattern> patterns;
@@ -339,8 +363,13 @@ int main(int argc, char** argv)
       usint* matches = 0;
       uint* sa_matches = 0;
       if(adaptive)    { matches = adaptive_samples->locate(patterns[i].range, count_steps); }
+      else if(cache)  { matches = sample_cache->locate(patterns[i].range, count_steps); }
       else if(use_sa) { sa_matches = sa->locate(patterns[i].range); }
-      else            { matches = rlcsa->locate(patterns[i].range, direct, count_steps); }
+      else
+      {
+        locate_type strategy = (direct ? LOCATE_DIRECT : (runs ? LOCATE_RUNS : LOCATE_ADAPTIVE));
+        matches = rlcsa->locate(patterns[i].range, strategy, count_steps);
+      }
       if(count_steps)
       {
         patterns[i].steps = 0;
@@ -467,9 +496,15 @@ int main(int argc, char** argv)
   // Cleanup.
 
   if(adaptive) { adaptive_samples->report(); }
+  if(cache)
+  {
+    sample_cache->report();
+    sample_cache->writeTo(base_name);
+  }
   delete rlcsa; rlcsa = 0;
   delete sa; sa = 0;
   delete adaptive_samples; adaptive_samples = 0;
+  delete sample_cache; sample_cache = 0;
   delete docarray; docarray = 0;
   delete[] totals; totals = 0;
   return 0;
@@ -481,6 +516,7 @@ printUsage()
 {
   std::cout << "Usage: rlcsa_test [options] base_name [patterns [threads]]" << std::endl;
   std::cout << "  -a   Use adaptive samples." << std::endl;
+  std::cout << "  -C   Use the sample cache, and write the learned samples after the test." << std::endl;
   std::cout << "  -d   Use direct locate / document listing." << std::endl;
   std::cout << "  -g#  Use the weights to generate # actual patterns." << std::endl;
   std::cout << "  -i#  Ignore first # characters of each pattern." << std::endl;
@@ -489,7 +525,8 @@ printUsage()
   std::cout << "  -o   Write the patterns sorted by occ/docc into patterns.sorted." << std::endl;
   std::cout << "  -p   Pattern file is in Pizza & Chili format." << std::endl;
   std::cout << "  -r   Run-length encode the results (requires -L)." << std::endl;
-  std::cout << "  -S   Use a plain suffix array (negates adaptive, direct, steps)." << std::endl;
+  std::cout << "  -R   Use run-based locate instead of adaptive locate." << std::endl;
+  std::cout << "  -S   Use a plain suffix array (negates adaptive, cache, direct, runs, steps)." << std::endl;
   std::cout << "  -s   Count the number of steps required for locate() (negates write)." << std::endl;
   std::cout << "  -W   Write selected and found patterns into patterns.selected and patterns.found." << std::endl;
   std::cout << "  -w   Write the weighted number of occurrences of each suffix into patterns.found." << std::endl;
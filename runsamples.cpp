@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "runsamples.h"
+#include "rlcsa.h"
+#include "misc/utils.h"
+
+#ifdef MULTITHREAD_SUPPORT
+#include <omp.h>
+#endif
+
+
+namespace CSA
+{
+
+
+RunSamples::RunSamples(std::ifstream& sample_file, const RLCSA& rlcsa) :
+  toeholds(0), toehold_values(0),
+  phi_keys(0), phi_values(0),
+  identity(INDEX_IDENTITY_WORDS, 0),
+  ok(false)
+{
+  sample_file.read((char*)&(this->identity[0]), INDEX_IDENTITY_WORDS * sizeof(usint));
+  if(!sample_file || this->identity != rlcsa.getIdentity())
+  {
+    std::cerr << "RunSamples: The run samples were built for another index!" << std::endl;
+    return;
+  }
+
+  this->phi_keys = new DeltaVector(sample_file);
+  usint value_bits = length(this->phi_keys->getSize() - 1);
+  this->phi_values = new ReadBuffer(sample_file, this->phi_keys->getNumberOfItems(), value_bits);
+  this->toeholds = new DeltaVector(sample_file);
+  this->toehold_values = new ReadBuffer(sample_file, this->toeholds->getNumberOfItems(), value_bits);
+  this->ok = true;
+}
+
+RunSamples::RunSamples(FILE* sample_file, const RLCSA& rlcsa) :
+  toeholds(0), toehold_values(0),
+  phi_keys(0), phi_values(0),
+  identity(INDEX_IDENTITY_WORDS, 0),
+  ok(false)
+{
+  if(sample_file == 0) { return; }
+
+  if(!std::fread(&(this->identity[0]), INDEX_IDENTITY_WORDS * sizeof(usint), 1, sample_file) ||
+     this->identity != rlcsa.getIdentity())
+  {
+    std::cerr << "RunSamples: The run samples were built for another index!" << std::endl;
+    return;
+  }
+
+  this->phi_keys = new DeltaVector(sample_file);
+  usint value_bits = length(this->phi_keys->getSize() - 1);
+  this->phi_values = new ReadBuffer(sample_file, this->phi_keys->getNumberOfItems(), value_bits);
+  this->toeholds = new DeltaVector(sample_file);
+  this->toehold_values = new ReadBuffer(sample_file, this->toeholds->getNumberOfItems(), value_bits);
+  this->ok = true;
+}
+
+RunSamples::RunSamples(const RLCSA& rlcsa, usint threads) :
+  toeholds(0), toehold_values(0),
+  phi_keys(0), phi_values(0),
+  identity(rlcsa.getIdentity()),
+  ok(false)
+{
+  if(!(rlcsa.isOk()) || !(rlcsa.supportsLocate()))
+  {
+    std::cerr << "RunSamples: The index must support locate!" << std::endl;
+    return;
+  }
+
+  usint size = rlcsa.getSize(), sequences = rlcsa.getNumberOfSequences();
+  usint text_size = rlcsa.getTextSize();
+
+  /*
+    Collect the runs of each Psi vector. The runs may not be maximal, but extra
+    samples are harmless. Psi values below the number of sequences are end markers.
+    Psi of a run end pointing to an end marker does not need a phi sample, as the
+    next text position starts another sequence. The BWT positions not covered by
+    Psi are the suffixes starting a sequence.
+  */
+  std::vector<usint> starts;
+  std::vector<pair_type> ends, covered;
+  for(usint c = 0; c < CHARS; c++)
+  {
+    if(rlcsa.array[c] == 0) { continue; }
+    PsiVector::Iterator iter(*(rlcsa.array[c]));
+    usint items = rlcsa.array[c]->getNumberOfItems();
+    usint offset = rlcsa.alphabet->cumulative(c);
+    usint rank = 0;
+    pair_type run = iter.selectRun(0, items);
+    while(true)
+    {
+      starts.push_back(offset + rank);
+      covered.push_back(pair_type(run.first, run.first + run.second));
+      if(run.first + run.second >= sequences)
+      {
+        ends.push_back(pair_type(offset + rank + run.second, run.first + run.second - sequences));
+      }
+      rank += run.second + 1;
+      if(rank >= items) { break; }
+      run = iter.selectNextRun(items);
+    }
+  }
+
+  std::sort(covered.begin(), covered.end());
+  std::vector<usint> sequence_starts;
+  usint next = 0;
+  for(std::vector<pair_type>::iterator iter = covered.begin(); iter != covered.end(); ++iter)
+  {
+    for(; next < iter->first; next++)
+    {
+      if(next >= sequences) { sequence_starts.push_back(next - sequences); }
+    }
+    next = iter->second + 1;
+  }
+  for(; next < size + sequences; next++) { sequence_starts.push_back(next - sequences); }
+  covered.clear();
+
+  /*
+    Locate the samples. A run end i with Psi(i) = j (in SA coordinates) gives
+    phi(SA[i] + 1) = SA[j + 1]. A sequence start j gives phi(SA[j]) = SA[j + 1].
+    phi of the last suffix in SA order is undefined and stored as 0.
+  */
+  usint* toehold_buffer = new usint[starts.size()];
+  usint phi_samples = ends.size() + sequence_starts.size();
+  pair_type* phi_buffer = new pair_type[phi_samples];
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #pragma omp parallel
+  #endif
+  {
+    QueryContext context(rlcsa);
+    #ifdef MULTITHREAD_SUPPORT
+    #pragma omp for schedule(static)
+    #endif
+    for(sint i = 0; i < (sint)starts.size(); i++)
+    {
+      toehold_buffer[i] = rlcsa.locate(starts[i], context);
+    }
+    #ifdef MULTITHREAD_SUPPORT
+    #pragma omp for schedule(static)
+    #endif
+    for(sint i = 0; i < (sint)phi_samples; i++)
+    {
+      pair_type sample = (i < (sint)ends.size() ? ends[i] : pair_type(size, sequence_starts[i - ends.size()]));
+      usint key = (sample.first < size ? rlcsa.locate(sample.first, context) + 1 : rlcsa.locate(sample.second, context));
+      usint value = (sample.second + 1 < size ? rlcsa.locate(sample.second + 1, context) : 0);
+      phi_buffer[i] = pair_type(key, value);
+    }
+  }
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #endif
+  parallelSort(phi_buffer, phi_buffer + phi_samples);
+
+  usint value_bits = length(text_size - 1);
+  DeltaEncoder toehold_encoder(BLOCK_SIZE);
+  WriteBuffer toehold_writer(starts.size(), value_bits);
+  for(usint i = 0; i < starts.size(); i++)
+  {
+    toehold_encoder.setBit(starts[i]);
+    toehold_writer.writeItem(toehold_buffer[i]);
+  }
+  this->toeholds = new DeltaVector(toehold_encoder, size);
+  this->toehold_values = toehold_writer.getReadBuffer();
+  delete[] toehold_buffer;
+
+  DeltaEncoder phi_encoder(BLOCK_SIZE);
+  WriteBuffer phi_writer(phi_samples, value_bits);
+  for(usint i = 0; i < phi_samples; i++)
+  {
+    phi_encoder.setBit(phi_buffer[i].first);
+    phi_writer.writeItem(phi_buffer[i].second);
+  }
+  this->phi_keys = new DeltaVector(phi_encoder, text_size);
+  this->phi_values = phi_writer.getReadBuffer();
+  delete[] phi_buffer;
+
+  this->ok = true;
+}
+
+RunSamples::~RunSamples()
+{
+  delete this->toeholds; this->toeholds = 0;
+  delete this->toehold_values; this->toehold_values = 0;
+  delete this->phi_keys; this->phi_keys = 0;
+  delete this->phi_values; this->phi_values = 0;
+}
+
+//--------------------------------------------------------------------------
+
+void
+RunSamples::writeTo(std::ofstream& sample_file) const
+{
+  sample_file.write((char*)&(this->identity[0]), INDEX_IDENTITY_WORDS * sizeof(usint));
+  this->phi_keys->writeTo(sample_file);
+  this->phi_values->writeBuffer(sample_file);
+  this->toeholds->writeTo(sample_file);
+  this->toehold_values->writeBuffer(sample_file);
+}
+
+void
+RunSamples::writeTo(FILE* sample_file) const
+{
+  if(sample_file == 0) { return; }
+
+  std::fwrite(&(this->identity[0]), INDEX_IDENTITY_WORDS * sizeof(usint), 1, sample_file);
+  this->phi_keys->writeTo(sample_file);
+  this->phi_values->writeBuffer(sample_file);
+  this->toeholds->writeTo(sample_file);
+  this->toehold_values->writeBuffer(sample_file);
+}
+
+usint
+RunSamples::reportSize() const
+{
+  usint bytes = sizeof(*this) + this->identity.capacity() * sizeof(usint);
+  bytes += this->toeholds->reportSize() + this->toehold_values->reportSize();
+  bytes += this->phi_keys->reportSize() + this->phi_values->reportSize();
+  return bytes;
+}
+
+
+} // namespace CSA
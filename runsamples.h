@@ -0,0 +1,98 @@
+#ifndef RUNSAMPLES_H
+#define RUNSAMPLES_H
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "bits/bitbuffer.h"
+#include "bits/deltavector.h"
+
+
+namespace CSA
+{
+
+
+class RLCSA;
+
+
+/*
+  Suffix array samples at the boundaries of Psi runs, following the r-index.
+  The space is O(r), where r is the number of runs, instead of O(n / d).
+
+  Toeholds are SA[i] for the positions i starting a run. Backward searching
+  can maintain SA[sp] for the current range [sp, ep] using the toeholds.
+
+  phi(SA[i]) = SA[i + 1]. If Psi(i + 1) = Psi(i) + 1, then
+  phi(SA[i] + 1) = phi(SA[i]) + 1. Hence it is enough to store phi(j) for the
+  text positions j that follow the end of a run, and for the first positions of
+  the sequences. phi(j) for other j is found from the preceding stored value.
+  Given SA[sp], the rest of the range is located in O(ep - sp) phi steps.
+
+  The file starts with the identity of the index. Samples built for another index
+  are not loaded.
+*/
+
+class RunSamples
+{
+  public:
+    const static usint BLOCK_SIZE = 16;
+
+    RunSamples(std::ifstream& sample_file, const RLCSA& rlcsa);
+    RunSamples(FILE* sample_file, const RLCSA& rlcsa);
+
+    // Requires an index supporting locate.
+    RunSamples(const RLCSA& rlcsa, usint threads = 1);
+    ~RunSamples();
+
+    void writeTo(std::ofstream& sample_file) const;
+    void writeTo(FILE* sample_file) const;
+
+    inline bool isOk() const { return this->ok; }
+
+    // Sets value = SA[sa_index] and returns true, if sa_index is a toehold.
+    inline bool getToehold(usint sa_index, usint& value) const
+    {
+      DeltaVector::Iterator iter(*(this->toeholds));
+      pair_type next = iter.valueAfter(sa_index);
+      if(next.first != sa_index) { return false; }
+      value = this->toehold_values->readItemConst(next.second);
+      return true;
+    }
+
+    // Returns SA[i + 1] for SA[i] = value. The result is undefined for the last
+    // suffix in SA order.
+    inline usint phi(usint value) const
+    {
+      DeltaVector::Iterator iter(*(this->phi_keys));
+      pair_type prev = iter.valueBefore(value);
+      return this->phi_values->readItemConst(prev.second) + (value - prev.first);
+    }
+
+    inline usint getNumberOfToeholds() const { return this->toeholds->getNumberOfItems(); }
+    inline usint getNumberOfPhiSamples() const { return this->phi_keys->getNumberOfItems(); }
+
+    usint reportSize() const;
+
+  private:
+    DeltaVector* toeholds;        // Over SA positions.
+    ReadBuffer*  toehold_values;
+
+    DeltaVector* phi_keys;        // Over text positions.
+    ReadBuffer*  phi_values;
+
+    std::vector<usint> identity;
+
+    bool ok;
+
+    // These are not allowed.
+    RunSamples();
+    RunSamples(const RunSamples&);
+    RunSamples& operator = (const RunSamples&);
+};
+
+
+} // namespace CSA
+
+
+#endif // RUNSAMPLES_H
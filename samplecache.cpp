@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "container.h"
+#include "samplecache.h"
+
+
+namespace CSA
+{
+
+
+SampleCache::SampleCache(const RLCSA& rlcsa, usint capacity, usint _min_steps) :
+  index(rlcsa),
+  shard_size(0), min_steps(_min_steps),
+  ok(false)
+{
+  this->initialize(capacity);
+}
+
+SampleCache::SampleCache(const RLCSA& rlcsa, const std::string& base_name, usint capacity, usint _min_steps) :
+  index(rlcsa),
+  shard_size(0), min_steps(_min_steps),
+  ok(false)
+{
+  this->initialize(capacity);
+  if(!(this->ok)) { return; }
+
+  std::ifstream cache_file;
+  if(!openIndexFile(base_name, SAMPLE_CACHE_EXTENSION, cache_file)) { return; }
+
+  // The header identifies the index the samples were learned for.
+  std::vector<usint> identity(INDEX_IDENTITY_WORDS, 0);
+  usint samples = 0;
+  cache_file.read((char*)&(identity[0]), INDEX_IDENTITY_WORDS * sizeof(usint));
+  cache_file.read((char*)&samples, sizeof(samples));
+  if(!cache_file || identity != this->index.getIdentity())
+  {
+    std::cerr << "SampleCache: The sample cache does not match the index!" << std::endl;
+    return;
+  }
+
+  for(usint i = 0; i < samples; i++)
+  {
+    pair_type sample;
+    cache_file.read((char*)&sample, sizeof(sample));
+    if(!cache_file) { break; }
+    if(sample.first < this->index.getSize() && sample.second < this->index.getTextSize())
+    {
+      this->insert(sample.first, sample.second);
+    }
+  }
+  cache_file.close();
+}
+
+SampleCache::~SampleCache()
+{
+  for(usint i = 0; i < SHARDS; i++)
+  {
+    delete[] this->shards[i].slots; this->shards[i].slots = 0;
+    #ifdef MULTITHREAD_SUPPORT
+    if(this->ok) { omp_destroy_lock(&(this->shards[i].lock)); }
+    #endif
+  }
+}
+
+void
+SampleCache::initialize(usint capacity)
+{
+  for(usint i = 0; i < SHARDS; i++) { this->shards[i].slots = 0; }
+  if(!(this->index.isOk()) || !(this->index.supportsLocate()))
+  {
+    std::cerr << "SampleCache: The index must support locate!" << std::endl;
+    return;
+  }
+
+  this->shard_size = std::max((capacity + SHARDS - 1) / SHARDS, (usint)1);
+  this->min_steps = std::max(this->min_steps, (usint)1);
+  for(usint i = 0; i < SHARDS; i++)
+  {
+    Shard& shard = this->shards[i];
+    shard.slots = new pair_type[this->shard_size];
+    shard.items = shard.hits = shard.misses = 0;
+    #ifdef MULTITHREAD_SUPPORT
+    omp_init_lock(&(shard.lock));
+    #endif
+  }
+  this->ok = true;
+  this->clear();
+}
+
+void
+SampleCache::writeTo(const std::string& base_name) const
+{
+  if(!(this->ok)) { return; }
+
+  std::string cache_name = base_name + SAMPLE_CACHE_EXTENSION;
+  std::ofstream cache_file(cache_name.c_str(), std::ios_base::binary);
+  if(!cache_file)
+  {
+    std::cerr << "SampleCache: Error creating sample cache file!" << std::endl;
+    return;
+  }
+
+  std::vector<usint> identity = this->index.getIdentity();
+  usint samples = this->getNumberOfSamples();
+  cache_file.write((char*)&(identity[0]), INDEX_IDENTITY_WORDS * sizeof(usint));
+  cache_file.write((char*)&samples, sizeof(samples));
+  for(usint i = 0; i < SHARDS; i++)
+  {
+    const Shard& shard = this->shards[i];
+    for(usint j = 0; j < this->shard_size; j++)
+    {
+      if(shard.slots[j].first < this->index.getSize())
+      {
+        cache_file.write((char*)&(shard.slots[j]), sizeof(pair_type));
+      }
+    }
+  }
+  cache_file.close();
+}
+
+//--------------------------------------------------------------------------
+
+usint
+SampleCache::locate(usint index, bool steps)
+{
+  QueryContext context(this->index);
+  return this->locate(index, context, steps);
+}
+
+usint
+SampleCache::locate(usint index, QueryContext& context, bool steps)
+{
+  if(!(this->ok) || index >= this->index.getSize()) { return (steps ? 0 : this->index.getSize()); }
+
+  // Same as RLCSA::directLocate(), except that the cache is checked after the samples.
+  usint sa_index = index, offset = 0, value = 0;
+  bool found_in_cache = false;
+  this->index.convertToBWTIndex(index);
+  while(true)
+  {
+    if(this->index.hasImplicitSample(index))
+    {
+      value = this->index.getImplicitSample(index);
+      break;
+    }
+    this->index.convertToSAIndex(index);
+    if(this->index.getSASamples()->isSampled(index))
+    {
+      value = this->index.getSASamples()->getSampleAt(index);
+      break;
+    }
+    if(this->find(index, value)) { found_in_cache = true; break; }
+    index = this->index.psi(index, context);
+    offset++;
+  }
+  value -= offset;
+
+  if(!found_in_cache)
+  {
+    Shard& shard = this->shardFor(hash(sa_index));
+    #ifdef MULTITHREAD_SUPPORT
+    omp_set_lock(&(shard.lock));
+    #endif
+    shard.misses++;
+    #ifdef MULTITHREAD_SUPPORT
+    omp_unset_lock(&(shard.lock));
+    #endif
+  }
+  if(offset >= this->min_steps) { this->insert(sa_index, value); }
+
+  return (steps ? offset : value);
+}
+
+usint*
+SampleCache::locate(pair_type range, bool steps)
+{
+  QueryContext context(this->index);
+  return this->locate(range, context, steps);
+}
+
+usint*
+SampleCache::locate(pair_type range, QueryContext& context, bool steps)
+{
+  if(!(this->ok) || isEmpty(range) || range.second >= this->index.getSize()) { return 0; }
+
+  usint* data = new usint[length(range)];
+  for(usint i = 0, j = range.first; j <= range.second; i++, j++)
+  {
+    data[i] = this->locate(j, context, steps);
+  }
+
+  return data;
+}
+
+void
+SampleCache::clear()
+{
+  if(!(this->ok)) { return; }
+
+  pair_type empty(this->index.getSize(), 0);
+  for(usint i = 0; i < SHARDS; i++)
+  {
+    Shard& shard = this->shards[i];
+    #ifdef MULTITHREAD_SUPPORT
+    omp_set_lock(&(shard.lock));
+    #endif
+    std::fill(shard.slots, shard.slots + this->shard_size, empty);
+    shard.items = 0;
+    #ifdef MULTITHREAD_SUPPORT
+    omp_unset_lock(&(shard.lock));
+    #endif
+  }
+}
+
+//--------------------------------------------------------------------------
+
+usint
+SampleCache::getNumberOfSamples() const
+{
+  usint temp = 0;
+  if(this->ok) { for(usint i = 0; i < SHARDS; i++) { temp += this->shards[i].items; } }
+  return temp;
+}
+
+usint
+SampleCache::getHits() const
+{
+  usint temp = 0;
+  if(this->ok) { for(usint i = 0; i < SHARDS; i++) { temp += this->shards[i].hits; } }
+  return temp;
+}
+
+usint
+SampleCache::getMisses() const
+{
+  usint temp = 0;
+  if(this->ok) { for(usint i = 0; i < SHARDS; i++) { temp += this->shards[i].misses; } }
+  return temp;
+}
+
+usint
+SampleCache::reportSize() const
+{
+  usint bytes = sizeof(*this);
+  if(this->ok) { bytes += SHARDS * this->shard_size * sizeof(pair_type); }
+  return bytes;
+}
+
+void
+SampleCache::report() const
+{
+  std::cout << "Sample cache:" << std::endl;
+  std::cout << "Size:     " << this->reportSize() / (double)MEGABYTE << " MB" << std::endl;
+  std::cout << "Samples:  " << this->getNumberOfSamples() << " / " << this->getCapacity() << std::endl;
+  std::cout << "Hits:     " << this->getHits() << " (" << this->getMisses() << " misses)" << std::endl;
+  std::cout << std::endl;
+}
+
+//--------------------------------------------------------------------------
+
+bool
+SampleCache::find(usint sa_index, usint& value)
+{
+  usint hash_value = hash(sa_index);
+  Shard& shard = this->shardFor(hash_value);
+  pair_type& slot = shard.slots[this->slotFor(hash_value)];
+
+  bool found = false;
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_lock(&(shard.lock));
+  #endif
+  if(slot.first == sa_index) { value = slot.second; found = true; shard.hits++; }
+  #ifdef MULTITHREAD_SUPPORT
+  omp_unset_lock(&(shard.lock));
+  #endif
+
+  return found;
+}
+
+void
+SampleCache::insert(usint sa_index, usint value)
+{
+  usint hash_value = hash(sa_index);
+  Shard& shard = this->shardFor(hash_value);
+  pair_type& slot = shard.slots[this->slotFor(hash_value)];
+
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_lock(&(shard.lock));
+  #endif
+  if(slot.first >= this->index.getSize()) { shard.items++; }
+  slot = pair_type(sa_index, value);
+  #ifdef MULTITHREAD_SUPPORT
+  omp_unset_lock(&(shard.lock));
+  #endif
+}
+
+
+} // namespace CSA
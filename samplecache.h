@@ -0,0 +1,123 @@
+#ifndef SAMPLECACHE_H
+#define SAMPLECACHE_H
+
+#include <string>
+
+#include "rlcsa.h"
+
+#ifdef MULTITHREAD_SUPPORT
+#include <omp.h>
+#endif
+
+
+namespace CSA
+{
+
+
+/*
+  A cache of additional SA samples learned from the positions located through it.
+  When locate(i) takes at least getMinSteps() Psi steps, SA[i] is stored in the
+  cache, so that locating i again or any position reaching i with Psi takes fewer
+  steps. Unlike AdaptiveSamples, the cache works with multiple sequences and the
+  regular SA samples of the index, and it can be used by multiple threads.
+
+  The cache is a direct-mapped hash table split into SHARDS shards. Each shard has
+  its own lock, so threads only wait for each other when they access the same shard.
+  A new sample replaces the old one in its slot.
+
+  The learned samples can be written next to the index and loaded later.
+*/
+
+class SampleCache
+{
+  public:
+    const static usint SHARDS = 64;
+    const static usint DEFAULT_CAPACITY = 1 << 20;
+    const static usint DEFAULT_MIN_STEPS = 4;
+
+    // Requires an index supporting locate.
+    SampleCache(const RLCSA& rlcsa, usint capacity = DEFAULT_CAPACITY, usint min_steps = DEFAULT_MIN_STEPS);
+
+    // Loads the samples from base_name + SAMPLE_CACHE_EXTENSION, if the file exists.
+    SampleCache(const RLCSA& rlcsa, const std::string& base_name,
+      usint capacity = DEFAULT_CAPACITY, usint min_steps = DEFAULT_MIN_STEPS);
+    ~SampleCache();
+
+    // Writes the learned samples to base_name + SAMPLE_CACHE_EXTENSION.
+    void writeTo(const std::string& base_name) const;
+
+    inline bool isOk() const { return this->ok; }
+
+//--------------------------------------------------------------------------
+
+    // Returns SA[index]. Steps means returning the number of Psi steps taken instead.
+    usint locate(usint index, bool steps = false);
+    usint locate(usint index, QueryContext& context, bool steps = false);
+
+    // Returns SA[range]. User must free the buffer.
+    usint* locate(pair_type range, bool steps = false);
+    usint* locate(pair_type range, QueryContext& context, bool steps = false);
+
+    // Removes all learned samples.
+    void clear();
+
+//--------------------------------------------------------------------------
+
+    inline usint getCapacity() const { return this->SHARDS * this->shard_size; }
+    inline usint getMinSteps() const { return this->min_steps; }
+
+    // Hits are locates ending at a cached sample, and misses the rest.
+    // These are not synchronized with concurrent queries.
+    usint getNumberOfSamples() const;
+    usint getHits() const;
+    usint getMisses() const;
+
+    usint reportSize() const;
+    void report() const;
+
+//--------------------------------------------------------------------------
+
+  private:
+    struct Shard
+    {
+      pair_type* slots;   // (SA index, SA value); empty slots have SA index >= size.
+      usint      items, hits, misses;
+      #ifdef MULTITHREAD_SUPPORT
+      omp_lock_t lock;
+      #endif
+    };
+
+    const RLCSA& index;
+    Shard        shards[SHARDS];
+    usint        shard_size, min_steps;
+
+    bool ok;
+
+    void initialize(usint capacity);
+
+    // Returns true and sets value = SA[sa_index] if the sample is in the cache.
+    bool find(usint sa_index, usint& value);
+    void insert(usint sa_index, usint value);
+
+    inline static usint hash(usint key)
+    {
+      unsigned long long temp = key;
+      temp = (temp ^ (temp >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      temp = (temp ^ (temp >> 27)) * 0x94D049BB133111EBULL;
+      return (usint)(temp ^ (temp >> 31));
+    }
+
+    inline Shard& shardFor(usint hash_value) { return this->shards[hash_value % SHARDS]; }
+    inline usint slotFor(usint hash_value) const { return (hash_value / SHARDS) % this->shard_size; }
+
+    // These are not allowed.
+    SampleCache();
+    SampleCache(const SampleCache&);
+    SampleCache& operator = (const SampleCache&);
+};
+
+
+} // namespace CSA
+
+
+#endif // SAMPLECACHE_H
@@ -38,6 +38,9 @@ class Sampler
     inline uint getSize() const { return this->size; }
     inline uint getItems() const { return this->number_of_samples; }
 
+    // Returns the text position of the ith sample. Valid only when the status is SAMPLED.
+    inline uint getSamplePosition(uint i) const { return this->samples[i].second; }
+
   protected:
     uint size, status;
 
@@ -18,7 +18,7 @@ namespace CSA
 
 //--------------------------------------------------------------------------
 
-SASamples::SASamples(std::ifstream& sample_file, usint sample_rate, bool _weighted) :
+SASamples::SASamples(std::ifstream& sample_file, usint sample_rate, bool _weighted, usint index_encoding, bool stored_indexes) :
   weighted(_weighted)
 {
   if(this->weighted)
@@ -36,15 +36,20 @@ SASamples::SASamples(std::ifstream& sample_file, usint sample_rate, bool _weight
   else
   {
     this->rate = sample_rate;
-    this->indexes = new SAVector(sample_file);
+    this->indexes = new SAVector(sample_file, index_encoding, stored_indexes);
     this->size = indexes->getSize();
     this->items = indexes->getNumberOfItems();
     this->samples = new ReadBuffer(sample_file, this->items, length(this->items - 1));
-    this->buildInverseSamples();
+    if(stored_indexes)
+    {
+      this->inverse_indexes = 0;
+      this->inverse_samples = new ReadBuffer(sample_file, this->items, length(this->items - 1));
+    }
+    else { this->buildInverseSamples(); }
   }
 }
 
-SASamples::SASamples(FILE* sample_file, usint sample_rate, bool _weighted) :
+SASamples::SASamples(FILE* sample_file, usint sample_rate, bool _weighted, usint index_encoding) :
   weighted(_weighted)
 {
   if(sample_file == 0) { return; }
@@ -64,7 +69,7 @@ SASamples::SASamples(FILE* sample_file, usint sample_rate, bool _weighted) :
   else
   {
     this->rate = sample_rate;
-    this->indexes = new SAVector(sample_file);
+    this->indexes = new SAVector(sample_file, index_encoding);
     this->size = indexes->getSize();
     this->items = indexes->getNumberOfItems();
     this->samples = new ReadBuffer(sample_file, this->items, length(this->items - 1));
@@ -72,6 +77,36 @@ SASamples::SASamples(FILE* sample_file, usint sample_rate, bool _weighted) :
   }
 }
 
+SASamples::SASamples(FileMap& sample_file, usint sample_rate, bool _weighted, usint index_encoding, bool stored_indexes) :
+  weighted(_weighted),
+  indexes(0), samples(0), inverse_indexes(0), inverse_samples(0)
+{
+  if(this->weighted)
+  {
+    this->rate = 1;
+    this->size = sample_file.readWord();
+    this->items = sample_file.readWord();
+
+    const usint* source = sample_file.readWords(2 * this->items);
+    if(source == 0) { return; }
+    pair_type* sample_pairs = new pair_type[this->items];
+    for(usint i = 0; i < this->items; i++) { sample_pairs[i] = pair_type(source[2 * i], source[2 * i + 1]); }
+    this->buildSamples(sample_pairs, false, 1);
+    this->buildSamples(sample_pairs, true, 1);
+    delete[] sample_pairs;
+  }
+  else
+  {
+    this->rate = sample_rate;
+    this->indexes = new SAVector(sample_file, index_encoding, stored_indexes);
+    this->size = indexes->getSize();
+    this->items = indexes->getNumberOfItems();
+    this->samples = new ReadBuffer(sample_file, this->items, length(this->items - 1));
+    if(stored_indexes) { this->inverse_samples = new ReadBuffer(sample_file, this->items, length(this->items - 1)); }
+    else if(sample_file.isOk()) { this->buildInverseSamples(); }
+  }
+}
+
 SASamples::SASamples(short_pair* sa, DeltaVector* end_points, usint data_size, usint sample_rate, usint threads) :
   weighted(false),
   rate(sample_rate),
@@ -152,6 +187,40 @@ SASamples::SASamples(pair_type* sample_pairs, usint data_size, usint sample_rate
   this->buildInverseSamples();
 }
 
+SASamples::SASamples(std::vector<pair_type>& sample_pairs, usint text_size, usint sample_rate, usint threads) :
+  weighted(false),
+  rate(sample_rate), size(text_size), items(sample_pairs.size())
+{
+  #ifdef MULTITHREAD_SUPPORT
+  omp_set_num_threads(threads);
+  #endif
+  parallelSort(sample_pairs.begin(), sample_pairs.end());
+
+  // Compress the samples.
+  WriteBuffer sample_buffer(this->items, length(this->items - 1));
+  SAVector::Encoder encoder(INDEX_BLOCK_SIZE);
+  for(usint i = 0; i < this->items; i++)
+  {
+    encoder.setBit(sample_pairs[i].first);
+    sample_buffer.writeItem(sample_pairs[i].second / this->rate);
+  }
+  sample_pairs.clear();
+
+  this->indexes = new SAVector(encoder, this->size);
+  this->samples = sample_buffer.getReadBuffer();
+  this->buildInverseSamples();
+}
+
+SASamples::SASamples(std::vector<pair_type>& sample_pairs, usint text_size, usint threads) :
+  weighted(true),
+  rate(1), size(text_size), items(sample_pairs.size())
+{
+  if(this->items == 0) { sample_pairs.push_back(pair_type(0, 0)); }
+  this->buildSamples(&(sample_pairs[0]), false, threads);
+  this->buildSamples(&(sample_pairs[0]), true, threads);
+  sample_pairs.clear();
+}
+
 SASamples::SASamples(SASamples& index, SASamples& increment, usint* positions, usint number_of_positions, usint number_of_sequences) :
   weighted(false),
   rate(index.rate),
@@ -173,7 +242,7 @@ SASamples::~SASamples()
 //--------------------------------------------------------------------------
 
 void
-SASamples::writeTo(std::ofstream& sample_file) const
+SASamples::writeTo(std::ofstream& sample_file, bool store_indexes) const
 {
   if(this->weighted)
   {
@@ -192,7 +261,9 @@ SASamples::writeTo(std::ofstream& sample_file) const
   else
   {
     this->indexes->writeTo(sample_file);
+    if(store_indexes) { this->indexes->writeIndexesTo(sample_file); }
     this->samples->writeBuffer(sample_file);
+    if(store_indexes) { this->inverse_samples->writeBuffer(sample_file); }
   }
 }
 
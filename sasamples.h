@@ -3,39 +3,34 @@
 
 #include <cstdio>
 #include <fstream>
+#include <vector>
 
 #include "sampler.h"
 #include "misc/utils.h"
 #include "bits/bitbuffer.h"
 
-#include "bits/deltavector.h"
-
-#ifdef SUCCINCT_SA_VECTOR
-#include "bits/succinctvector.h"
-#endif
+#include "bits/savector.h"
 
 namespace CSA
 {
 
 
-#ifdef SUCCINCT_SA_VECTOR
-typedef SuccinctVector SAVector;
-#else
-typedef DeltaVector SAVector;
-#endif
-
-
 class SASamples
 {
   public:
-    #ifdef SUCCINCT_SA_VECTOR
-    const static usint INDEX_BLOCK_SIZE = 32;
-    #else
     const static usint INDEX_BLOCK_SIZE = 16;
-    #endif
 
-    SASamples(std::ifstream& sample_file, usint sample_rate, bool _weighted);
-    SASamples(FILE* sample_file, usint sample_rate, bool _weighted);
+    // index_encoding is the SAVector encoding of the sampled positions.
+    // It is ignored for weighted samples, as their indexes are rebuilt when loading.
+    // If stored_indexes is true, the rank/select indexes and the inverse samples of
+    // regular samples are read from the file instead of being rebuilt.
+    SASamples(std::ifstream& sample_file, usint sample_rate, bool _weighted, usint index_encoding = SAVector::DELTA,
+      bool stored_indexes = false);
+    SASamples(FILE* sample_file, usint sample_rate, bool _weighted, usint index_encoding = SAVector::DELTA);
+
+    // The regular samples point to the mapped file. Weighted samples are copied.
+    SASamples(FileMap& sample_file, usint sample_rate, bool _weighted, usint index_encoding = SAVector::DELTA,
+      bool stored_indexes = false);
 
     // These assume < 4 GB data.
     SASamples(short_pair* sa, DeltaVector* end_points, usint data_size, usint sample_rate, usint threads);
@@ -44,6 +39,15 @@ class SASamples
     // Use these samples. Assumes regular sampling.
     SASamples(pair_type* sample_pairs, usint data_size, usint sample_rate, usint threads);
 
+    // Use these (SA index, text position) pairs as regular samples. The positions must be
+    // the multiples of sample_rate up to text_size - 1. The vector is cleared.
+    SASamples(std::vector<pair_type>& sample_pairs, usint text_size, usint sample_rate, usint threads);
+
+    // Use these (SA index, text position) pairs as weighted samples. The positions can be
+    // arbitrary, but display requires sampling the first position of each sequence.
+    // The vector is cleared.
+    SASamples(std::vector<pair_type>& sample_pairs, usint text_size, usint threads);
+
     ~SASamples();
 
     // Destroys contents of index and increment.
@@ -52,7 +56,8 @@ class SASamples
     // number_of_sequences is subtracted from each position before the value is used.
     SASamples(SASamples& index, SASamples& increment, usint* positions, usint number_of_positions, usint number_of_sequences);
 
-    void writeTo(std::ofstream& sample_file) const;
+    // Regular samples can be written with the indexes for loading with stored_indexes.
+    void writeTo(std::ofstream& sample_file, bool store_indexes = false) const;
     void writeTo(FILE* sample_file) const;
 
     // Returns (i, inverseSA(i)) such that i is the last sampled position up to value.
@@ -90,6 +95,7 @@ class SASamples
     inline usint getNumberOfSamples() const { return this->items; }
 
     inline bool isWeighted() const { return this->weighted; }
+    inline usint getIndexEncoding() const { return this->indexes->getEncoding(); }
     inline bool supportsLocate() const { return (this->samples != 0); }
     inline bool supportsDisplay() const { return (this->inverse_samples != 0); }
 